@@ -0,0 +1,183 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Compare opening and scanning a file of many small groups, attributes and
+// datasets for the default and the paged file space strategy.
+//
+// Usage: benchmark_file_space [groups [page_size [page_buffer [repeat]]]]
+//
+// Before each run, the file is evicted from the page cache of the
+// operating system, if supported, to approximate a cold open.
+//
+
+#include <h5xx/h5xx.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+double now()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+std::string group_name(unsigned int i)
+{
+    std::ostringstream name;
+    name << "step/" << i;
+    return name.str();
+}
+
+void evict_page_cache(std::string const& name)
+{
+#ifdef POSIX_FADV_DONTNEED
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#endif
+}
+
+void write_file(std::string const& name, h5xx::file_creation const& creation, unsigned int groups)
+{
+    // close all objects together with the file
+    H5::FileAccPropList fapl;
+    fapl.setFcloseDegree(H5F_CLOSE_STRONG);
+    H5::H5File file(name, H5F_ACC_TRUNC, creation.property(name), fapl);
+
+    std::vector<double> position(48);
+    for (unsigned int i = 0; i < groups; ++i) {
+        H5::Group group = h5xx::open_group(file, group_name(i));
+        std::fill(position.begin(), position.end(), i);
+        h5xx::attribute_batch()
+            .add("step", i)
+            .add("time", 0.01 * i)
+            .add("unit", "sigma")
+            .add("box", std::vector<double>(3, 10.))
+            .write(group);
+        h5xx::write_dataset(h5xx::create_dataset<std::vector<double> >(group, "position", position.size()), position);
+        h5xx::write_dataset(h5xx::create_dataset<unsigned int>(group, "count"), i);
+    }
+}
+
+struct timing
+{
+    double open;
+    double scan;
+};
+
+timing scan_file(std::string const& name, h5xx::file_access const& access, unsigned int groups)
+{
+    timing t;
+    double start = now();
+    H5::H5File file = h5xx::open_file(name, H5F_ACC_RDONLY, access);
+    t.open = now() - start;
+
+    std::vector<double> position;
+    unsigned int count;
+    std::size_t nattr = 0;
+    for (unsigned int i = 0; i < groups; ++i) {
+        H5::Group group = file.openGroup(group_name(i));
+        nattr += h5xx::read_attributes(group).size();
+        h5xx::read_dataset(group, "position", position);
+        h5xx::read_dataset(group, "count", count);
+    }
+    t.scan = now() - start - t.open;
+    if (nattr != 4 * groups) {
+        throw std::runtime_error("unexpected number of attributes");
+    }
+    return t;
+}
+
+void run(
+    std::string const& label, std::string const& name
+  , h5xx::file_access const& access, unsigned int groups, unsigned int repeat)
+{
+    std::vector<double> open_time, scan_time;
+    for (unsigned int i = 0; i < repeat; ++i) {
+        evict_page_cache(name);
+        timing t = scan_file(name, access, groups);
+        open_time.push_back(t.open);
+        scan_time.push_back(t.scan);
+    }
+    std::sort(open_time.begin(), open_time.end());
+    std::sort(scan_time.begin(), scan_time.end());
+
+    H5::H5File file = h5xx::open_file(name);
+    std::printf(
+        "%-24s %10.3f %10.3f %12.1f\n", label.c_str()
+      , 1e3 * open_time[repeat / 2], 1e3 * scan_time[repeat / 2], file.getFileSize() / 1024.
+    );
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned int groups = argc > 1 ? std::atoi(argv[1]) : 2000;
+    hsize_t page_size = argc > 2 ? std::atol(argv[2]) : 65536;
+    std::size_t page_buffer = argc > 3 ? std::atol(argv[3]) : 16 << 20;
+    unsigned int repeat = argc > 4 ? std::atoi(argv[4]) : 5;
+    if (groups == 0 || repeat == 0 || page_buffer < page_size) {
+        std::cerr << "Usage: " << argv[0] << " [groups [page_size [page_buffer [repeat]]]]" << std::endl;
+        return 1;
+    }
+
+    std::string const default_name = "benchmark_file_space_default.h5";
+    std::string const paged_name = "benchmark_file_space_paged.h5";
+    try {
+        write_file(default_name, h5xx::file_creation(), groups);
+        write_file(paged_name, h5xx::file_creation::paged(page_size), groups);
+
+        std::cout << groups << " groups, page size " << page_size << " bytes, page buffer "
+                  << page_buffer << " bytes, median of " << repeat << " runs" << std::endl;
+        std::printf("%-24s %10s %10s %12s\n", "layout", "open (ms)", "scan (ms)", "size (KiB)");
+        h5xx::file_access access = h5xx::file_access().page_buffer(page_buffer);
+        run("default", default_name, h5xx::file_access(), groups, repeat);
+        run("paged", paged_name, h5xx::file_access(), groups, repeat);
+        run("paged + page buffer", paged_name, access, groups, repeat);
+    }
+    catch (std::exception const& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (H5::Exception const& e) {
+        std::cerr << "error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    }
+
+    unlink(default_name.c_str());
+    unlink(paged_name.c_str());
+    return 0;
+}
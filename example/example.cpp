@@ -35,7 +35,7 @@ int main(int argc, char** argv)
     H5::DataSet dataset = group.openDataSet("array");
 
     //
-    // read dataset of rank 3 by iterating over the first index
+    // read dataset of rank 3, which stores arrays of rank 2 along the first index
     //
 
     // use boost::multi_array to read arrays of rank 2
@@ -49,10 +49,14 @@ int main(int argc, char** argv)
 
     std::cout << "Read " << n << " arrays of shape (" << shape[0] << "," << shape[1] << ")" << std::endl;
 
+    //
+    // read all n arrays at once into an array of rank 3
+    //
+    boost::multi_array<float, 3> all_data;
+    h5xx::read_chunked_dataset(dataset, all_data, 0, n);
+
     for (unsigned int i = 0; i < n; ++i) {
-        array_type data;
-        h5xx::read_chunked_dataset(dataset, data, i);
-        std::cout << "/group/array[" << i << ", 0, 0] = " << data[0][0] << std::endl;
+        std::cout << "/group/array[" << i << ", 0, 0] = " << all_data[i][0][0] << std::endl;
     }
 
     return 0;
@@ -0,0 +1,303 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H5XX_ASYNC_WRITER_HPP
+#define H5XX_ASYNC_WRITER_HPP
+
+#include <h5xx/chunked_dataset.hpp>
+#include <h5xx/error.hpp>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace h5xx {
+namespace detail {
+
+/**
+ * datasets written to by the I/O thread, which holds a reference to each
+ */
+typedef std::map<hid_t, H5::DataSet> async_dataset_map;
+
+/**
+ * pending operation of the asynchronous writer, run by the I/O thread
+ */
+struct async_job
+{
+    virtual ~async_job() {}
+    virtual void run(async_dataset_map& datasets) = 0;
+};
+
+/**
+ * staged record to be written to a chunked dataset
+ *
+ * The job refers to the dataset by its id only, the reference to the
+ * dataset is taken in the I/O thread.
+ */
+template <typename T>
+struct async_write_job
+  : async_job
+{
+    async_write_job(hid_t dataset, T const& data, hsize_t index)
+      : dataset(dataset)
+      , data(data)
+      , index(index) {}
+
+    void run(async_dataset_map& datasets)
+    {
+        async_dataset_map::iterator it = datasets.find(dataset);
+        if (it == datasets.end()) {
+            it = datasets.insert(std::make_pair(dataset, H5::DataSet(dataset))).first;
+        }
+        h5xx::write_chunked_dataset(it->second, data, index);
+    }
+
+    hid_t const dataset;
+    T const data;
+    hsize_t const index;
+};
+
+/**
+ * flush the files of all datasets written to and release the datasets
+ */
+struct async_flush_job
+  : async_job
+{
+    void run(async_dataset_map& datasets)
+    {
+        // release the references also if flushing fails
+        async_dataset_map flushed;
+        flushed.swap(datasets);
+        for (async_dataset_map::const_iterator it = flushed.begin(); it != flushed.end(); ++it) {
+            if (H5Fflush(it->first, H5F_SCOPE_LOCAL) < 0) {
+                throw error("failed to flush HDF5 file");
+            }
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * Asynchronous writer for chunked datasets
+ *
+ * write() copies the record to a staging queue and returns immediately,
+ * the records are then written by a dedicated I/O thread in the order of
+ * submission. If the queue holds 'buffers' records already, write() blocks
+ * until the I/O thread has taken up the oldest one.
+ *
+ * An error in the I/O thread is re-thrown as h5xx::error by the next call
+ * of write(), wait() or flush() in the calling thread; records submitted
+ * after the failed one are discarded.
+ *
+ * Only the I/O thread calls the HDF5 library; write(), wait() and flush()
+ * do not. The jobs refer to the datasets passed to write() by their ids,
+ * the I/O thread takes its own reference to each dataset and keeps it
+ * until the next flush() has completed. The caller's H5::DataSet objects
+ * must remain open while writes are pending, but may be destroyed before
+ * the next flush().
+ *
+ * Unless the HDF5 library is built thread-safe, the calling threads must
+ * not use the HDF5 library while writes are pending, i.e., only after
+ * wait() or flush() returned.
+ *
+ * This header is not included by h5xx/h5xx.hpp and requires linking to
+ * the Boost.Thread library.
+ */
+class async_writer
+  : boost::noncopyable
+{
+public:
+    explicit async_writer(std::size_t buffers=2)
+      : buffers_(buffers)
+      , busy_(false)
+      , stop_(false)
+    {
+        if (buffers_ == 0) {
+            throw error("async_writer: number of buffers must be positive");
+        }
+        thread_ = boost::thread(runner(this));
+    }
+
+    /**
+     * finish pending writes and terminate the I/O thread
+     *
+     * Errors cannot be reported from the destructor, call wait() before.
+     */
+    ~async_writer()
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        not_empty_.notify_one();
+        thread_.join();
+    }
+
+    /**
+     * stage record for writing to chunked dataset at given index, default
+     * argument appends to dataset, see write_chunked_dataset()
+     */
+    template <typename T>
+    void write(H5::DataSet const& dataset, T const& data, hsize_t index=H5S_UNLIMITED)
+    {
+        job_ptr job(new detail::async_write_job<T>(dataset.getId(), data, index));
+        {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            while (queue_.size() >= buffers_ && error_.empty()) {
+                not_full_.wait(lock);
+            }
+            rethrow(lock);
+            queue_.push_back(job);
+        }
+        not_empty_.notify_one();
+    }
+
+    /**
+     * block until all pending writes are completed
+     */
+    void wait()
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        while ((!queue_.empty() || busy_) && error_.empty()) {
+            idle_.wait(lock);
+        }
+        rethrow(lock);
+    }
+
+    /**
+     * complete pending writes and flush the files of all datasets written to
+     */
+    void flush()
+    {
+        job_ptr job(new detail::async_flush_job);
+        {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            queue_.push_back(job);
+        }
+        not_empty_.notify_one();
+        wait();
+    }
+
+    /** maximum number of staged records */
+    std::size_t buffers() const
+    {
+        return buffers_;
+    }
+
+private:
+    typedef boost::shared_ptr<detail::async_job> job_ptr;
+
+    struct runner
+    {
+        runner(async_writer* writer) : writer(writer) {}
+        void operator()() { writer->run(); }
+        async_writer* writer;
+    };
+
+    /** I/O thread */
+    void run()
+    {
+        for (;;) {
+            job_ptr job;
+            bool pending;
+            {
+                boost::unique_lock<boost::mutex> lock(mutex_);
+                while (queue_.empty() && !stop_) {
+                    not_empty_.wait(lock);
+                }
+                if (queue_.empty()) {
+                    break;
+                }
+                job = queue_.front();
+                queue_.pop_front();
+                busy_ = pending = error_.empty();
+            }
+            not_full_.notify_one();
+
+            if (pending) {
+                std::string what;
+                bool failed = true;
+                try {
+                    job->run(datasets_);
+                    failed = false;
+                }
+                catch (std::exception const& e) {
+                    what = e.what();
+                }
+                catch (H5::Exception const& e) {
+                    what = e.getDetailMsg();
+                }
+                catch (...) {}
+                if (failed && what.empty()) {
+                    what = "unknown error";
+                }
+                job.reset(); // release staged data outside the lock
+
+                boost::unique_lock<boost::mutex> lock(mutex_);
+                busy_ = false;
+                if (!what.empty()) {
+                    error_ = what;
+                    queue_.clear();
+                    not_full_.notify_all();
+                }
+            }
+            idle_.notify_all();
+        }
+        datasets_.clear();
+    }
+
+    /** throw and reset error of I/O thread, requires lock */
+    void rethrow(boost::unique_lock<boost::mutex>&)
+    {
+        if (!error_.empty()) {
+            std::string what;
+            what.swap(error_);
+            throw error("asynchronous write failed: " + what);
+        }
+    }
+
+    std::size_t const buffers_;
+    /** staged records and pending flushes */
+    std::deque<job_ptr> queue_;
+    /** datasets written to since last flush, used by the I/O thread only */
+    detail::async_dataset_map datasets_;
+    /** true while the I/O thread writes a record */
+    bool busy_;
+    bool stop_;
+    /** error message from I/O thread */
+    std::string error_;
+
+    boost::mutex mutex_;
+    boost::condition_variable not_empty_;
+    boost::condition_variable not_full_;
+    boost::condition_variable idle_;
+    boost::thread thread_;
+};
+
+} // namespace h5xx
+
+#endif /* ! H5XX_ASYNC_WRITER_HPP */
@@ -34,6 +34,10 @@
 #include <boost/type_traits.hpp>
 #include <boost/utility/enable_if.hpp>
 
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
 #include <vector>
 
 namespace h5xx {
@@ -50,6 +54,32 @@ inline bool exists_attribute(H5::H5Object const& object, std::string const& name
     return (tri > 0);
 }
 
+namespace detail {
+
+/**
+ * open attribute, throw H5::AttributeIException if it does not exist
+ */
+inline H5::Attribute open_attribute(H5::H5Object const& object, std::string const& name)
+{
+    if (!exists_attribute(object, name)) {
+        throw H5::AttributeIException("H5Object::openAttribute", "attribute \"" + name + "\" does not exist");
+    }
+    return object.openAttribute(name);
+}
+
+/**
+ * open attribute if it exists, return an invalid attribute otherwise
+ */
+inline H5::Attribute open_attribute_if_exists(H5::H5Object const& object, std::string const& name)
+{
+    if (!exists_attribute(object, name)) {
+        return H5::Attribute();
+    }
+    return object.openAttribute(name);
+}
+
+} // namespace detail
+
 /*
  * create and write fundamental type attribute
  */
@@ -57,17 +87,13 @@ template <typename T>
 inline typename boost::enable_if<boost::is_fundamental<T>, void>::type
 write_attribute(H5::H5Object const& object, std::string const& name, T const& value)
 {
-    H5::Attribute attr;
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
-        attr = object.openAttribute(name);
-        if (!has_type<T>(attr) || !has_scalar_space(attr)) {
-            // recreate attribute with proper type
-            object.removeAttr(name);
-            throw H5::AttributeIException();
-        }
+    H5::Attribute attr = detail::open_attribute_if_exists(object, name);
+    if (is_valid(attr.getId()) && (!has_type<T>(attr) || !has_scalar_space(attr))) {
+        // recreate attribute with proper type
+        attr.close();
+        object.removeAttr(name);
     }
-    catch (H5::AttributeIException const&) {
+    if (!is_valid(attr.getId())) {
         attr = object.createAttribute(name, ctype<T>::hid(), H5S_SCALAR);
     }
     attr.write(ctype<T>::hid(), &value);
@@ -80,14 +106,7 @@ template <typename T>
 inline typename boost::enable_if<boost::is_fundamental<T>, T>::type
 read_attribute(H5::H5Object const& object, std::string const& name)
 {
-    H5::Attribute attr;
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
-        attr = object.openAttribute(name);
-    }
-    catch (H5::AttributeIException const&) {
-        throw;
-    }
+    H5::Attribute attr = detail::open_attribute(object, name);
     if (!has_scalar_space(attr)) {
         throw H5::AttributeIException("H5::attribute::as", "incompatible dataspace");
     }
@@ -105,11 +124,9 @@ write_attribute(H5::H5Object const& object, std::string const& name, T const& va
 {
     H5::StrType tid(H5::PredType::C_S1, value.size());
     // remove attribute if it exists
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
+    if (exists_attribute(object, name)) {
         object.removeAttr(name);
     }
-    catch (H5::AttributeIException const&) {}
     H5::Attribute attr = object.createAttribute(name, tid, H5S_SCALAR);
     attr.write(tid, value.data());
 }
@@ -121,14 +138,7 @@ template <typename T>
 inline typename boost::enable_if<boost::is_same<T, std::string>, T>::type
 read_attribute(H5::H5Object const& object, std::string const& name)
 {
-    H5::Attribute attr;
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
-        attr = object.openAttribute(name);
-    }
-    catch (H5::AttributeIException const&) {
-        throw;
-    }
+    H5::Attribute attr = detail::open_attribute(object, name);
     if (!has_scalar_space(attr)) {
         throw H5::AttributeIException("H5::attribute::as", "incompatible dataspace");
     }
@@ -162,11 +172,9 @@ write_attribute(H5::H5Object const& object, std::string const& name, T value)
 {
     H5::StrType tid(H5::PredType::C_S1, strlen(value));
     // remove attribute if it exists
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
+    if (exists_attribute(object, name)) {
         object.removeAttr(name);
     }
-    catch (H5::AttributeIException const&) {}
     H5::Attribute attr = object.createAttribute(name, tid, H5S_SCALAR);
     attr.write(tid, value);
 }
@@ -181,17 +189,13 @@ write_attribute(H5::H5Object const& object, std::string const& name, T const& va
     typedef typename T::value_type value_type;
     enum { size = T::static_size };
 
-    H5::Attribute attr;
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
-        attr = object.openAttribute(name);
-        if (!has_type<T>(attr) || !has_extent<T>(attr)) {
-            // recreate attribute with proper type and size
-            object.removeAttr(name);
-            throw H5::AttributeIException();
-        }
+    H5::Attribute attr = detail::open_attribute_if_exists(object, name);
+    if (is_valid(attr.getId()) && (!has_type<T>(attr) || !has_extent<T>(attr))) {
+        // recreate attribute with proper type and size
+        attr.close();
+        object.removeAttr(name);
     }
-    catch (H5::AttributeIException const&) {
+    if (!is_valid(attr.getId())) {
         hsize_t dim[1] = { size };
         H5::DataSpace ds(1, dim);
         attr = object.createAttribute(name, ctype<value_type>::hid(), ds);
@@ -216,11 +220,9 @@ write_attribute(H5::H5Object const& object, std::string const& name, T const& va
     }
     H5::StrType tid(H5::PredType::C_S1, max_len);
     // remove attribute if it exists
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
+    if (exists_attribute(object, name)) {
         object.removeAttr(name);
     }
-    catch (H5::AttributeIException const&) {}
     H5::Attribute attr = object.createAttribute(name, tid, ds);
     std::vector<char> data(max_len * size);
     for (size_t i = 0; i < size; ++i) {
@@ -239,14 +241,7 @@ read_attribute(H5::H5Object const& object, std::string const& name)
     typedef typename T::value_type value_type;
     enum { size = T::static_size };
 
-    H5::Attribute attr;
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
-        attr = object.openAttribute(name);
-    }
-    catch (H5::AttributeIException const&) {
-        throw;
-    }
+    H5::Attribute attr = detail::open_attribute(object, name);
 
     if (!has_extent<T>(attr)) {
         throw H5::AttributeIException("H5::attribute::as", "incompatible dataspace");
@@ -267,17 +262,13 @@ write_attribute(H5::H5Object const& object, std::string const& name, T const& va
     typedef typename T::element value_type;
     enum { rank = T::dimensionality };
 
-    H5::Attribute attr;
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
-        attr = object.openAttribute(name);
-        if (!has_type<T>(attr) || !has_extent<T>(attr, value.shape())) {
-            // recreate attribute with proper type and size
-            object.removeAttr(name);
-            throw H5::AttributeIException();
-        }
+    H5::Attribute attr = detail::open_attribute_if_exists(object, name);
+    if (is_valid(attr.getId()) && (!has_type<T>(attr) || !has_extent<T>(attr, value.shape()))) {
+        // recreate attribute with proper type and size
+        attr.close();
+        object.removeAttr(name);
     }
-    catch (H5::AttributeIException const&) {
+    if (!is_valid(attr.getId())) {
         hsize_t dim[rank];
         std::copy(value.shape(), value.shape() + rank, dim);
         H5::DataSpace ds(rank, dim);
@@ -296,14 +287,7 @@ read_attribute(H5::H5Object const& object, std::string const& name)
     typedef typename T::element value_type;
     enum { rank = T::dimensionality };
 
-    H5::Attribute attr;
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
-        attr = object.openAttribute(name);
-    }
-    catch (H5::AttributeIException const&) {
-        throw;
-    }
+    H5::Attribute attr = detail::open_attribute(object, name);
 
     H5::DataSpace ds(attr.getSpace());
     if (!has_rank<rank>(attr)) {
@@ -330,17 +314,13 @@ write_attribute(H5::H5Object const& object, std::string const& name, T const& va
 {
     typedef typename T::value_type value_type;
 
-    H5::Attribute attr;
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
-        attr = object.openAttribute(name);
-        if (!has_type<T>(attr) || elements(attr) != value.size()) {
-            // recreate attribute with proper type
-            object.removeAttr(name);
-            throw H5::AttributeIException();
-        }
+    H5::Attribute attr = detail::open_attribute_if_exists(object, name);
+    if (is_valid(attr.getId()) && (!has_type<T>(attr) || elements(attr) != value.size())) {
+        // recreate attribute with proper type
+        attr.close();
+        object.removeAttr(name);
     }
-    catch (H5::AttributeIException const&) {
+    if (!is_valid(attr.getId())) {
         hsize_t dim[1] = { value.size() };
         H5::DataSpace ds(1, dim);
         attr = object.createAttribute(name, ctype<value_type>::hid(), ds);
@@ -361,14 +341,7 @@ read_attribute(H5::H5Object const& object, std::string const& name)
 {
     typedef typename T::value_type value_type;
 
-    H5::Attribute attr;
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
-        attr = object.openAttribute(name);
-    }
-    catch (H5::AttributeIException const&) {
-        throw;
-    }
+    H5::Attribute attr = detail::open_attribute(object, name);
 
     H5::DataSpace ds(attr.getSpace());
     if (!ds.isSimple()) {
@@ -428,14 +401,7 @@ inline typename boost::enable_if<boost::mpl::and_<
 >, T>::type
 read_attribute(H5::H5Object const& object, std::string const& name)
 {
-    H5::Attribute attr;
-    try {
-        H5XX_NO_AUTO_PRINT(H5::AttributeIException);
-        attr = object.openAttribute(name);
-    }
-    catch (H5::AttributeIException const&) {
-        throw;
-    }
+    H5::Attribute attr = detail::open_attribute(object, name);
 
     H5::DataSpace ds(attr.getSpace());
     if (!ds.isSimple()) {
@@ -477,6 +443,295 @@ inline boost::any read_attribute_if_exists(H5::H5Object const& object, std::stri
     return boost::any();
 }
 
+/**
+ * attribute names mapped to their values
+ */
+typedef std::map<std::string, boost::any> attribute_map;
+
+namespace detail {
+
+/** read simple or scalar attribute of given dimensions into multi_array of given rank */
+template <typename T, std::size_t rank>
+inline boost::any read_attribute_array(hid_t attr, std::vector<hsize_t> const& dims)
+{
+    boost::array<std::size_t, rank> shape;
+    std::copy(dims.begin(), dims.end(), shape.begin());
+    boost::multi_array<T, rank> value(shape);
+    if (value.num_elements() > 0 && H5Aread(attr, ctype<T>::hid(), value.origin()) < 0) {
+        throw error("failed to read attribute");
+    }
+    return value;
+}
+
+/**
+ * read attribute of element type T, preserving its shape: T for scalar,
+ * std::vector<T> for 1-dimensional, boost::multi_array<T, rank> for up to
+ * 4-dimensional attributes, and std::vector<T> of all elements otherwise
+ */
+template <typename T>
+inline boost::any read_attribute_any(hid_t attr, std::vector<hsize_t> const& dims)
+{
+    switch (dims.size()) {
+      case 0: {
+        T value;
+        if (H5Aread(attr, ctype<T>::hid(), &value) < 0) {
+            throw error("failed to read attribute");
+        }
+        return value;
+      }
+      case 2:
+        return read_attribute_array<T, 2>(attr, dims);
+      case 3:
+        return read_attribute_array<T, 3>(attr, dims);
+      case 4:
+        return read_attribute_array<T, 4>(attr, dims);
+      default: {
+        hsize_t size = 1;
+        for (std::size_t i = 0; i < dims.size(); ++i) {
+            size *= dims[i];
+        }
+        std::vector<T> value(size);
+        if (size > 0 && H5Aread(attr, ctype<T>::hid(), &*value.begin()) < 0) {
+            throw error("failed to read attribute");
+        }
+        return value;
+      }
+    }
+}
+
+/**
+ * variable-length strings allocated by the HDF5 library, which are freed
+ * by the library upon destruction
+ */
+class vlen_strings
+{
+public:
+    explicit vlen_strings(std::size_t size)
+      : c_str_(size, static_cast<char*>(NULL)) {}
+
+    ~vlen_strings()
+    {
+        for (std::size_t i = 0; i < c_str_.size(); ++i) {
+            if (c_str_[i]) {
+#if H5_VERSION_GE(1,8,13)
+                H5free_memory(c_str_[i]);
+#else
+                free(c_str_[i]);
+#endif
+            }
+        }
+    }
+
+    std::vector<char*>& c_str()
+    {
+        return c_str_;
+    }
+
+private:
+    vlen_strings(vlen_strings const&);
+    vlen_strings& operator=(vlen_strings const&);
+
+    std::vector<char*> c_str_;
+};
+
+/**
+ * read string attribute as std::string if scalar and as std::vector of all
+ * strings otherwise
+ */
+inline boost::any read_attribute_string(hid_t attr, hid_t type, std::vector<hsize_t> const& dims)
+{
+    hsize_t size = 1;
+    for (std::size_t i = 0; i < dims.size(); ++i) {
+        size *= dims[i];
+    }
+    std::vector<std::string> value;
+    value.reserve(size);
+
+    if (H5Tis_variable_str(type) > 0) {
+        // memory is allocated by the HDF5 C library and must be freed by it
+        vlen_strings strings(size);
+        std::vector<char*>& c_str = strings.c_str();
+        if (size > 0 && H5Aread(attr, type, &*c_str.begin()) < 0) {
+            throw error("failed to read string attribute");
+        }
+        for (std::size_t i = 0; i < c_str.size(); ++i) {
+            value.push_back(c_str[i] ? c_str[i] : "");
+        }
+    }
+    else {
+        std::size_t str_len = H5Tget_size(type);
+        std::vector<char> buffer(str_len * size);
+        if (!buffer.empty() && H5Aread(attr, type, &*buffer.begin()) < 0) {
+            throw error("failed to read string attribute");
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            char const* s = &*buffer.begin() + i * str_len;
+            value.push_back(std::string(s, strnlen(s, str_len)));
+        }
+    }
+
+    if (dims.empty()) {
+        return value.front();
+    }
+    return value;
+}
+
+/** read attribute of native integer or floating-point type */
+inline boost::any read_attribute_native(hid_t attr, hid_t native, std::vector<hsize_t> const& dims)
+{
+    // boolean values are stored as char
+    if (H5Tequal(native, ctype<char>::hid()) > 0) {
+        return read_attribute_any<char>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<signed char>::hid()) > 0) {
+        return read_attribute_any<signed char>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<unsigned char>::hid()) > 0) {
+        return read_attribute_any<unsigned char>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<short>::hid()) > 0) {
+        return read_attribute_any<short>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<unsigned short>::hid()) > 0) {
+        return read_attribute_any<unsigned short>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<int>::hid()) > 0) {
+        return read_attribute_any<int>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<unsigned int>::hid()) > 0) {
+        return read_attribute_any<unsigned int>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<long>::hid()) > 0) {
+        return read_attribute_any<long>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<unsigned long>::hid()) > 0) {
+        return read_attribute_any<unsigned long>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<long long>::hid()) > 0) {
+        return read_attribute_any<long long>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<unsigned long long>::hid()) > 0) {
+        return read_attribute_any<unsigned long long>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<float>::hid()) > 0) {
+        return read_attribute_any<float>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<double>::hid()) > 0) {
+        return read_attribute_any<double>(attr, dims);
+    }
+    if (H5Tequal(native, ctype<long double>::hid()) > 0) {
+        return read_attribute_any<long double>(attr, dims);
+    }
+    return boost::any();
+}
+
+/**
+ * read attribute of any supported type, return empty boost::any for other
+ * types, and throw if reading the attribute fails
+ */
+inline boost::any read_attribute_any(hid_t attr)
+{
+    hid_t type = H5Aget_type(attr);
+    hid_t space = H5Aget_space(attr);
+    hid_t native = -1;
+    boost::any value;
+
+    try {
+        int rank = (space >= 0) ? H5Sget_simple_extent_ndims(space) : -1;
+        if (type < 0 || rank < 0) {
+            throw error("failed to get data type or dataspace of attribute");
+        }
+        H5T_class_t type_class = H5Tget_class(type);
+        if (type_class == H5T_INTEGER || type_class == H5T_FLOAT || type_class == H5T_STRING) {
+            std::vector<hsize_t> dims(rank);
+            if (rank > 0) {
+                H5Sget_simple_extent_dims(space, &*dims.begin(), NULL);
+            }
+
+            if (type_class == H5T_STRING) {
+                value = read_attribute_string(attr, type, dims);
+            }
+            else {
+                native = H5Tget_native_type(type, H5T_DIR_ASCEND);
+                if (native < 0) {
+                    throw error("failed to get native data type of attribute");
+                }
+                value = read_attribute_native(attr, native, dims);
+            }
+        }
+    }
+    catch (...) {
+        if (native >= 0) H5Tclose(native);
+        if (type >= 0) H5Tclose(type);
+        if (space >= 0) H5Sclose(space);
+        throw;
+    }
+
+    if (native >= 0) H5Tclose(native);
+    if (type >= 0) H5Tclose(type);
+    if (space >= 0) H5Sclose(space);
+    return value;
+}
+
+struct read_attributes_context
+{
+    attribute_map* attributes;
+    bool failed;
+};
+
+inline herr_t read_attributes_visit(hid_t loc, char const* name, H5A_info_t const*, void* op_data)
+{
+    read_attributes_context* context = static_cast<read_attributes_context*>(op_data);
+    hid_t attr = H5Aopen(loc, name, H5P_DEFAULT);
+    if (attr < 0) {
+        context->failed = true;
+        return -1;
+    }
+    try {
+        boost::any value = read_attribute_any(attr);
+        if (!value.empty()) {
+            (*context->attributes)[name] = value;
+        }
+    }
+    catch (...) {
+        // do not propagate exceptions through the HDF5 library
+        context->failed = true;
+    }
+    H5Aclose(attr);
+    return context->failed ? -1 : 0;
+}
+
+} // namespace detail
+
+/**
+ * read all attributes of file, group or dataset by a single pass over
+ * the attributes
+ *
+ * Integer, floating-point and string attributes are stored in the map as
+ * boost::any holding the native C++ type of the attribute with its shape:
+ * scalars as T, 1-dimensional attributes as std::vector<T>, and attributes
+ * of rank 2 to 4 as boost::multi_array<T, rank>. String attributes are
+ * stored as std::string, or std::vector<std::string> if non-scalar, and
+ * attributes of higher rank as std::vector<T> of all elements. Integer
+ * types map to the first matching C++ type of char, short, int, long and
+ * long long, so that, e.g., 64-bit integers are returned as long on LP64
+ * platforms. Boolean attributes are returned as char, since they are
+ * stored as such. Other attributes, e.g., of compound type, are omitted.
+ */
+inline attribute_map read_attributes(H5::H5Object const& object)
+{
+    attribute_map attributes;
+    detail::read_attributes_context context = { &attributes, false };
+    hsize_t idx = 0;
+    herr_t err = H5Aiterate2(
+        object.getId(), H5_INDEX_NAME, H5_ITER_NATIVE, &idx, &detail::read_attributes_visit, &context
+    );
+    if (err < 0 || context.failed) {
+        throw error("failed to read attributes of object \"" + path(object) + "\"");
+    }
+    return attributes;
+}
+
 } // namespace h5xx
 
 #endif /* ! H5XX_ATTRIBUTE_HPP */
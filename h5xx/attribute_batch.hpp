@@ -0,0 +1,341 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H5XX_ATTRIBUTE_BATCH_HPP
+#define H5XX_ATTRIBUTE_BATCH_HPP
+
+#include <h5xx/ctype.hpp>
+#include <h5xx/error.hpp>
+#include <h5xx/utility.hpp>
+
+#include <boost/array.hpp>
+#include <boost/mpl/and.hpp>
+#include <boost/multi_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/type_traits.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace h5xx {
+
+/**
+ * Batch of attributes written to an HDF5 object at once
+ *
+ * The attributes are collected by add() and written by write(), which
+ * enumerates the existing attributes of the object once. An attribute is
+ * created if it does not exist, updated in place if data type and shape
+ * match, skipped if it holds the value already, and recreated otherwise.
+ * The attributes are accessed via the C API of HDF5, and no exceptions are
+ * raised unless an operation fails.
+ *
+ * The attributes are stored with the same data types and shapes as by
+ * write_attribute() and may be read by read_attribute(). Adding an
+ * attribute of a name that is already in the batch replaces its value.
+ *
+ *     attribute_batch()
+ *         .add("step", step)
+ *         .add("time", time)
+ *         .add("box", box_edges)
+ *         .write(dataset);
+ */
+class attribute_batch
+{
+public:
+    attribute_batch()
+      : created_(0)
+      , updated_(0)
+      , skipped_(0) {}
+
+    /** scalar attribute */
+    template <typename T>
+    typename boost::enable_if<has_ctype<T>, attribute_batch&>::type
+    add(std::string const& name, T const& value)
+    {
+        return add(name, copy_type(ctype<T>::hid()), std::vector<hsize_t>(), &value, sizeof(T));
+    }
+
+    /** string attribute, stored as fixed-length string */
+    attribute_batch& add(std::string const& name, std::string const& value)
+    {
+        return add(name, string_type(value.size()), std::vector<hsize_t>(), value.data(), value.size());
+    }
+
+    attribute_batch& add(std::string const& name, char const* value)
+    {
+        return add(name, std::string(value));
+    }
+
+    /** fixed-size array attribute */
+    template <typename T>
+    typename boost::enable_if<boost::mpl::and_<
+        is_array<T>, has_ctype<typename T::value_type>
+    >, attribute_batch&>::type
+    add(std::string const& name, T const& value)
+    {
+        typedef typename T::value_type value_type;
+        return add(
+            name, copy_type(ctype<value_type>::hid()), std::vector<hsize_t>(1, T::static_size)
+          , &*value.begin(), sizeof(value_type) * T::static_size
+        );
+    }
+
+    /** multi-dimensional array attribute */
+    template <typename T>
+    typename boost::enable_if<is_multi_array<T>, attribute_batch&>::type
+    add(std::string const& name, T const& value)
+    {
+        typedef typename T::element value_type;
+        enum { rank = T::dimensionality };
+        return add(
+            name, copy_type(ctype<value_type>::hid()), std::vector<hsize_t>(value.shape(), value.shape() + rank)
+          , value.origin(), sizeof(value_type) * value.num_elements()
+        );
+    }
+
+    /** vector attribute */
+    template <typename T>
+    typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, has_ctype<typename T::value_type>
+    >, attribute_batch&>::type
+    add(std::string const& name, T const& value)
+    {
+        typedef typename T::value_type value_type;
+        return add(
+            name, copy_type(ctype<value_type>::hid()), std::vector<hsize_t>(1, value.size())
+          , value.empty() ? NULL : &*value.begin(), sizeof(value_type) * value.size()
+        );
+    }
+
+    /** vector of strings, stored as array of fixed-length strings */
+    attribute_batch& add(std::string const& name, std::vector<std::string> const& value)
+    {
+        std::size_t str_len = 0;
+        for (std::size_t i = 0; i < value.size(); ++i) {
+            str_len = std::max(str_len, value[i].size());
+        }
+        str_len = std::max(str_len, std::size_t(1));
+        std::vector<char> buffer(str_len * value.size());
+        for (std::size_t i = 0; i < value.size(); ++i) {
+            value[i].copy(&*buffer.begin() + i * str_len, str_len);
+        }
+        return add(
+            name, string_type(str_len), std::vector<hsize_t>(1, value.size())
+          , buffer.empty() ? NULL : &*buffer.begin(), buffer.size()
+        );
+    }
+
+    /**
+     * write attributes to file, group or dataset
+     *
+     * Throws h5xx::error if an attribute cannot be written; the attributes
+     * written before are kept.
+     */
+    void write(H5::H5Object const& object)
+    {
+        hid_t loc = object.getId();
+        created_ = updated_ = skipped_ = 0;
+
+        // enumerate existing attributes once
+        std::set<std::string> existing;
+        hsize_t idx = 0;
+        if (H5Aiterate2(loc, H5_INDEX_NAME, H5_ITER_NATIVE, &idx, &collect_name, &existing) < 0) {
+            throw error("failed to iterate over attributes of object \"" + path(object) + "\"");
+        }
+
+        for (std::vector<entry>::const_iterator e = entries_.begin(); e != entries_.end(); ++e) {
+            bool exists = existing.find(e->name) != existing.end();
+            if (!(exists && update(loc, *e))) {
+                if (exists && H5Adelete(loc, e->name.c_str()) < 0) {
+                    throw error("failed to remove attribute \"" + e->name + "\"");
+                }
+                create(loc, *e);
+            }
+        }
+    }
+
+    /** number of attributes in the batch */
+    std::size_t size() const
+    {
+        return entries_.size();
+    }
+
+    /** remove all attributes from the batch */
+    void clear()
+    {
+        entries_.clear();
+        index_.clear();
+    }
+
+    /** number of attributes created by the last write(), including recreated ones */
+    std::size_t created() const
+    {
+        return created_;
+    }
+
+    /** number of existing attributes updated in place by the last write() */
+    std::size_t updated() const
+    {
+        return updated_;
+    }
+
+    /** number of existing attributes holding the value already in the last write() */
+    std::size_t skipped() const
+    {
+        return skipped_;
+    }
+
+private:
+    typedef boost::shared_ptr<detail::type_handle> type_ptr;
+
+    struct entry
+    {
+        std::string name;
+        type_ptr type;
+        /** dimensions, empty for scalar dataspace */
+        std::vector<hsize_t> dims;
+        /** raw data in memory layout of 'type' */
+        std::vector<char> data;
+    };
+
+    static type_ptr copy_type(hid_t type)
+    {
+        return type_ptr(new detail::type_handle(H5Tcopy(type)));
+    }
+
+    /** fixed-length string type, as H5::StrType(H5::PredType::C_S1, size) */
+    static type_ptr string_type(std::size_t size)
+    {
+        type_ptr type = copy_type(H5T_C_S1);
+        if (H5Tset_size(type->hid(), std::max(size, std::size_t(1))) < 0) {
+            throw error("failed to set size of string type");
+        }
+        return type;
+    }
+
+    attribute_batch& add(
+        std::string const& name, type_ptr type, std::vector<hsize_t> const& dims
+      , void const* data, std::size_t bytes)
+    {
+        std::map<std::string, std::size_t>::const_iterator i = index_.find(name);
+        if (i == index_.end()) {
+            i = index_.insert(std::make_pair(name, entries_.size())).first;
+            entries_.push_back(entry());
+        }
+        entry& e = entries_[i->second];
+        e.name = name;
+        e.type = type;
+        e.dims = dims;
+        // a string is padded with '\0' to the size of its type
+        std::size_t nelements = 1;
+        for (std::size_t j = 0; j < dims.size(); ++j) {
+            nelements *= dims[j];
+        }
+        e.data.assign(nelements * H5Tget_size(type->hid()), 0);
+        if (bytes > 0) {
+            std::memcpy(&*e.data.begin(), data, std::min(bytes, e.data.size()));
+        }
+        return *this;
+    }
+
+    static herr_t collect_name(hid_t, char const* name, H5A_info_t const*, void* names)
+    {
+        static_cast<std::set<std::string>*>(names)->insert(name);
+        return 0;
+    }
+
+    /** write existing attribute in place, return false if it does not match type and shape */
+    bool update(hid_t loc, entry const& e)
+    {
+        hid_t attr = H5Aopen(loc, e.name.c_str(), H5P_DEFAULT);
+        if (attr < 0) {
+            return false;
+        }
+        hid_t type = H5Aget_type(attr);
+        hid_t space = H5Aget_space(attr);
+        bool match = type >= 0 && space >= 0 && H5Tequal(type, e.type->hid()) > 0;
+        if (match) {
+            H5S_class_t space_class = H5Sget_simple_extent_type(space);
+            if (e.dims.empty()) {
+                match = space_class == H5S_SCALAR;
+            }
+            else {
+                std::vector<hsize_t> dims(e.dims.size());
+                match = space_class == H5S_SIMPLE
+                    && H5Sget_simple_extent_ndims(space) == int(e.dims.size())
+                    && H5Sget_simple_extent_dims(space, &*dims.begin(), NULL) >= 0
+                    && dims == e.dims;
+            }
+        }
+
+        bool success = true;
+        if (match) {
+            // compare with stored value
+            std::vector<char> buffer(e.data.size());
+            bool equal = buffer.empty()
+                || (H5Aread(attr, e.type->hid(), &*buffer.begin()) >= 0 && buffer == e.data);
+            if (equal) {
+                ++skipped_;
+            }
+            else {
+                success = H5Awrite(attr, e.type->hid(), &*e.data.begin()) >= 0;
+                ++updated_;
+            }
+        }
+        if (type >= 0) H5Tclose(type);
+        if (space >= 0) H5Sclose(space);
+        H5Aclose(attr);
+        if (!success) {
+            throw error("failed to write attribute \"" + e.name + "\"");
+        }
+        return match;
+    }
+
+    void create(hid_t loc, entry const& e)
+    {
+        hid_t space = e.dims.empty()
+            ? H5Screate(H5S_SCALAR)
+            : H5Screate_simple(e.dims.size(), &*e.dims.begin(), NULL);
+        hid_t attr = space >= 0
+            ? H5Acreate2(loc, e.name.c_str(), e.type->hid(), space, H5P_DEFAULT, H5P_DEFAULT)
+            : -1;
+        bool success = attr >= 0 && (e.data.empty() || H5Awrite(attr, e.type->hid(), &*e.data.begin()) >= 0);
+        if (attr >= 0) H5Aclose(attr);
+        if (space >= 0) H5Sclose(space);
+        if (!success) {
+            throw error("failed to create attribute \"" + e.name + "\"");
+        }
+        ++created_;
+    }
+
+    std::vector<entry> entries_;
+    std::map<std::string, std::size_t> index_;
+    std::size_t created_;
+    std::size_t updated_;
+    std::size_t skipped_;
+};
+
+} // namespace h5xx
+
+#endif /* ! H5XX_ATTRIBUTE_BATCH_HPP */
@@ -0,0 +1,277 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H5XX_CHUNK_POLICY_HPP
+#define H5XX_CHUNK_POLICY_HPP
+
+#include <h5xx/error.hpp>
+#include <h5xx/hdf5_compat.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+namespace h5xx {
+namespace detail {
+
+// http://www.hdfgroup.org/training/HDFtraining/UsersGuide/Perform.fm2.html
+// It is recommended that the chunk size be at least 8K bytes.
+enum { CHUNK_MIN_SIZE = 8192 };
+
+// size of the default raw data chunk cache of HDF5, H5D_CHUNK_CACHE_NBYTES_DEFAULT
+enum { CHUNK_MAX_SIZE = 1048576 };
+
+} // namespace detail
+
+/**
+ * Chunk shape policy for chunked datasets
+ *
+ * The policy determines the shape of the chunks of a dataset holding
+ * records of fixed shape. Except for explicit chunk dimensions, a chunk
+ * spans whole records and the policy chooses the number of records per
+ * chunk, i.e., the chunk size along the outermost dimension, which is
+ * limited by the maximum extent of the dataset.
+ *
+ * The default policy doubles the number of records per chunk until the
+ * chunk holds at least detail::CHUNK_MIN_SIZE bytes. The shape applied to
+ * a dataset is stored in the file and may be queried by chunk_shape().
+ *
+ * The tiles() policy bounds the size of a chunk also for large records and
+ * is used for datasets of fixed shape created by create_dataset().
+ */
+class chunk_policy
+{
+public:
+    /** at least 'bytes' bytes per chunk, with a power of two of records */
+    static chunk_policy min_bytes(std::size_t bytes=detail::CHUNK_MIN_SIZE)
+    {
+        return chunk_policy(MIN_BYTES, bytes);
+    }
+
+    /** as many records as fit into 'bytes' bytes, at least one record */
+    static chunk_policy bytes(std::size_t bytes)
+    {
+        if (bytes == 0) {
+            throw error("chunk_policy: chunk size must be positive");
+        }
+        return chunk_policy(BYTES, bytes);
+    }
+
+    /** fixed number of records per chunk */
+    static chunk_policy records(hsize_t records)
+    {
+        if (records == 0) {
+            throw error("chunk_policy: number of records must be positive");
+        }
+        return chunk_policy(RECORDS, records);
+    }
+
+    /**
+     * explicit chunk dimensions, including the outermost dimension;
+     * the rank must match the rank of the dataset
+     */
+    static chunk_policy dims(std::vector<hsize_t> const& dims)
+    {
+        if (dims.empty() || std::find(dims.begin(), dims.end(), hsize_t(0)) != dims.end()) {
+            throw error("chunk_policy: chunk dimensions must be positive");
+        }
+        chunk_policy policy(DIMS, 0);
+        policy.dims_ = dims;
+        return policy;
+    }
+
+    /**
+     * as many records as fit into the raw data chunk cache of the file
+     * together with 'chunks' - 1 further chunks, at least one record
+     *
+     * Choose chunks > 1 if several datasets of the file are accessed
+     * alternately, e.g., one chunk per dataset.
+     */
+    static chunk_policy cache(unsigned int chunks=1)
+    {
+        if (chunks == 0) {
+            throw error("chunk_policy: number of chunks must be positive");
+        }
+        return chunk_policy(CACHE, chunks);
+    }
+
+    /**
+     * tiles of at most 'bytes' bytes, or a single element if larger
+     *
+     * The dataset is split along the outermost dimensions first, so that
+     * a chunk spans complete rows of the innermost dimensions, and into
+     * tiles of equal size along each split dimension. An unlimited
+     * dimension is split as if it was arbitrarily large, unless the chunk
+     * fits already, then its chunk extent is 1.
+     */
+    static chunk_policy tiles(std::size_t bytes=detail::CHUNK_MAX_SIZE)
+    {
+        if (bytes == 0) {
+            throw error("chunk_policy: chunk size must be positive");
+        }
+        return chunk_policy(TILES, bytes);
+    }
+
+    /** default policy, see min_bytes() */
+    chunk_policy()
+      : kind_(MIN_BYTES)
+      , param_(detail::CHUNK_MIN_SIZE) {}
+
+    /**
+     * compute chunk dimensions of a dataset with given dimensions and
+     * element size, the dataset will be created at 'loc'
+     *
+     * chunk_dim[1:] are set to the record shape, dim[1:], and chunk_dim[0]
+     * to the number of records per chunk.
+     */
+    std::vector<hsize_t> operator()(
+        std::vector<hsize_t> const& max_dim, std::size_t type_size, hid_t loc) const
+    {
+        if (kind_ == DIMS) {
+            if (dims_.size() != max_dim.size()) {
+                throw error("chunk_policy: chunk dimensions do not match rank of dataset");
+            }
+            std::vector<hsize_t> chunk_dim(dims_);
+            for (std::size_t i = 0; i < chunk_dim.size(); ++i) {
+                if (max_dim[i] != H5S_UNLIMITED) {
+                    chunk_dim[i] = std::min(chunk_dim[i], std::max(max_dim[i], hsize_t(1)));
+                }
+            }
+            return chunk_dim;
+        }
+        if (kind_ == TILES) {
+            return tiles(max_dim, type_size);
+        }
+
+        std::vector<hsize_t> chunk_dim(max_dim);
+        hsize_t record_bytes = std::accumulate(
+            chunk_dim.begin() + 1, chunk_dim.end(), hsize_t(type_size), std::multiplies<hsize_t>()
+        );
+        record_bytes = std::max(record_bytes, hsize_t(1));
+
+        switch (kind_) {
+          case MIN_BYTES:
+            // increase outermost dimension of chunk by powers of two until size of
+            // dataset is equal to or greater than recommended minimum chunk size
+            chunk_dim[0] = 1;
+            while (chunk_dim[0] * record_bytes < param_) {
+                chunk_dim[0] *= 2;
+            }
+            break;
+          case BYTES:
+            chunk_dim[0] = param_ / record_bytes;
+            break;
+          case RECORDS:
+            chunk_dim[0] = param_;
+            break;
+          case CACHE:
+            chunk_dim[0] = cache_size(loc) / param_ / record_bytes;
+            break;
+          default:
+            break;
+        }
+        chunk_dim[0] = std::max(chunk_dim[0], hsize_t(1));
+        if (max_dim[0] != H5S_UNLIMITED) {
+            chunk_dim[0] = std::min(chunk_dim[0], std::max(max_dim[0], hsize_t(1)));
+        }
+        return chunk_dim;
+    }
+
+private:
+    enum kind_type { MIN_BYTES, BYTES, RECORDS, DIMS, CACHE, TILES };
+
+    chunk_policy(kind_type kind, hsize_t param)
+      : kind_(kind)
+      , param_(param) {}
+
+    /** split dimensions from the outermost one until a chunk fits into param_ bytes */
+    std::vector<hsize_t> tiles(std::vector<hsize_t> const& max_dim, std::size_t type_size) const
+    {
+        std::vector<hsize_t> chunk_dim(max_dim.size());
+        for (std::size_t i = 0; i < max_dim.size(); ++i) {
+            chunk_dim[i] = (max_dim[i] == H5S_UNLIMITED) ? max_dim[i] : std::max(max_dim[i], hsize_t(1));
+        }
+        for (std::size_t i = 0; i < chunk_dim.size(); ++i) {
+            // size of a chunk with extent 1 along dimension i
+            hsize_t inner_bytes = type_size;
+            for (std::size_t j = i + 1; j < chunk_dim.size(); ++j) {
+                inner_bytes *= (chunk_dim[j] == H5S_UNLIMITED) ? 1 : chunk_dim[j];
+            }
+            hsize_t extent = std::max(hsize_t(param_) / std::max(inner_bytes, hsize_t(1)), hsize_t(1));
+            if (chunk_dim[i] == H5S_UNLIMITED) {
+                chunk_dim[i] = extent;
+            }
+            else if (chunk_dim[i] > extent) {
+                // split into the least number of tiles of (almost) equal extent
+                hsize_t tiles = (chunk_dim[i] + extent - 1) / extent;
+                chunk_dim[i] = (chunk_dim[i] + tiles - 1) / tiles;
+            }
+            if (chunk_dim[i] * inner_bytes <= param_) {
+                break;
+            }
+        }
+        std::replace(chunk_dim.begin(), chunk_dim.end(), H5S_UNLIMITED, hsize_t(1));
+        return chunk_dim;
+    }
+
+    /** size of the raw data chunk cache of the file containing 'loc' */
+    static hsize_t cache_size(hid_t loc)
+    {
+        size_t nslots, nbytes;
+        double w0;
+        hid_t file = H5Iget_file_id(loc);
+        if (file < 0) {
+            throw error("failed to determine file of HDF5 object");
+        }
+        hid_t fapl = H5Fget_access_plist(file);
+        H5Fclose(file);
+        if (fapl < 0) {
+            throw error("failed to get file access property list");
+        }
+        herr_t err = H5Pget_cache(fapl, NULL, &nslots, &nbytes, &w0);
+        H5Pclose(fapl);
+        if (err < 0) {
+            throw error("failed to get chunk cache parameters");
+        }
+        return nbytes;
+    }
+
+    kind_type kind_;
+    hsize_t param_;
+    std::vector<hsize_t> dims_;
+};
+
+/**
+ * return chunk dimensions of chunked dataset
+ */
+inline std::vector<hsize_t> chunk_shape(H5::DataSet const& dataset)
+{
+    H5::DSetCreatPropList cparms(dataset.getCreatePlist());
+    if (cparms.getLayout() != H5D_CHUNKED) {
+        throw error("dataset is not chunked");
+    }
+    std::vector<hsize_t> chunk_dim(dataset.getSpace().getSimpleExtentNdims());
+    cparms.getChunk(chunk_dim.size(), &*chunk_dim.begin());
+    return chunk_dim;
+}
+
+} // namespace h5xx
+
+#endif /* ! H5XX_CHUNK_POLICY_HPP */
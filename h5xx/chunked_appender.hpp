@@ -0,0 +1,293 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H5XX_CHUNKED_APPENDER_HPP
+#define H5XX_CHUNKED_APPENDER_HPP
+
+#include <h5xx/chunked_dataset.hpp>
+#include <h5xx/error.hpp>
+#include <h5xx/utility.hpp>
+
+#include <boost/array.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+namespace h5xx {
+
+/**
+ * Growth policy for the outermost extent of unlimited chunked datasets
+ *
+ * The default policy extends the dataset by exactly the number of
+ * appended records. The geometric and chunk-wise policies allocate
+ * records in advance and thus amortise the extent changes, which update
+ * the dataset's metadata in the file.
+ */
+class extent_growth
+{
+public:
+    /** grow extent to the number of records */
+    static extent_growth exact()
+    {
+        return extent_growth(EXACT, 1);
+    }
+
+    /** grow extent by a constant factor > 1 */
+    static extent_growth geometric(double factor=2)
+    {
+        if (!(factor > 1)) {
+            throw error("extent_growth: factor must be greater than 1");
+        }
+        return extent_growth(GEOMETRIC, factor);
+    }
+
+    /** grow extent by multiples of 'chunks' chunks along the outermost dimension */
+    static extent_growth chunks(unsigned int chunks=1)
+    {
+        if (chunks == 0) {
+            throw error("extent_growth: number of chunks must be positive");
+        }
+        return extent_growth(CHUNKS, chunks);
+    }
+
+    /**
+     * return new extent holding at least 'required' records, given the
+     * current extent and the chunk size along the outermost dimension
+     */
+    hsize_t operator()(hsize_t extent, hsize_t required, hsize_t chunk_size) const
+    {
+        switch (kind_) {
+          case GEOMETRIC:
+            extent = std::max(extent, hsize_t(1));
+            while (extent < required) {
+                extent = std::max(extent + 1, static_cast<hsize_t>(extent * param_));
+            }
+            return extent;
+          case CHUNKS: {
+            hsize_t step = chunk_size * static_cast<hsize_t>(param_);
+            return (required + step - 1) / step * step;
+          }
+          default:
+            return required;
+        }
+    }
+
+    /** true for policies that depend on the chunk size */
+    bool is_chunked() const
+    {
+        return kind_ == CHUNKS;
+    }
+
+private:
+    enum kind_type { EXACT, GEOMETRIC, CHUNKS };
+
+    extent_growth(kind_type kind, double param)
+      : kind_(kind)
+      , param_(param) {}
+
+    kind_type kind_;
+    double param_;
+};
+
+/**
+ * Buffered appender for chunked datasets
+ *
+ * Records are collected in memory and appended to the dataset in batches
+ * of up to 'capacity' records, using a single extension of the dataspace
+ * and a single hyperslab write per batch. The record type T is any type
+ * supported by write_chunked_dataset(), i.e., scalars, boost::array,
+ * boost::multi_array, std::vector of scalars or of boost::array.
+ *
+ * The record shape is taken from the dataset upon construction. Remaining
+ * records are written by flush(), which is also called by the destructor;
+ * since errors cannot be reported from the destructor, call flush()
+ * explicitly before the appender goes out of scope.
+ *
+ * Optionally, the extent of the dataset grows according to the given
+ * policy, see extent_growth. The appender then keeps track of the number
+ * of valid records, and flush() trims the extent to that length. Records
+ * beyond the logical length hold the fill value until then. The dataset
+ * must not be extended or appended to by other means while the appender
+ * is in use.
+ */
+template <typename T>
+class chunked_appender
+  : boost::noncopyable
+{
+private:
+    typedef detail::record_traits<T> traits_type;
+
+public:
+    typedef T record_type;
+    typedef typename traits_type::value_type value_type;
+    enum { rank = traits_type::rank };
+
+    chunked_appender(
+        H5::DataSet const& dataset
+      , std::size_t capacity
+      , extent_growth const& growth=extent_growth::exact()
+    )
+      : dataset_(dataset)
+      , capacity_(capacity)
+      , size_(0)
+      , growth_(growth)
+      , chunk_size_(1)
+    {
+        if (capacity_ == 0) {
+            throw error("chunked_appender: capacity must be positive");
+        }
+        H5::DataSpace dataspace(dataset_.getSpace());
+        if (!has_rank<rank+1>(dataspace)) {
+            throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace");
+        }
+        boost::array<hsize_t, rank+1> max_dim;
+        dataspace.getSimpleExtentDims(&*dim_.begin(), &*max_dim.begin());
+        record_size_ = std::accumulate(dim_.begin() + 1, dim_.end(), hsize_t(1), std::multiplies<hsize_t>());
+        length_ = dim_[0];
+        max_length_ = max_dim[0];
+        if (growth_.is_chunked()) {
+            boost::array<hsize_t, rank+1> chunk_dim;
+            dataset_.getCreatePlist().getChunk(chunk_dim.size(), &*chunk_dim.begin());
+            chunk_size_ = chunk_dim[0];
+        }
+        buffer_.reset(new value_type[capacity_ * record_size_]);
+    }
+
+    ~chunked_appender()
+    {
+        try {
+            flush();
+        }
+        catch (...) {}
+    }
+
+    /**
+     * append record to buffer, write buffer to dataset if full
+     */
+    void push_back(T const& record)
+    {
+        if (!traits_type::has_shape(record, &*dim_.begin() + 1)) {
+            throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace");
+        }
+        value_type const* data = traits_type::data(record);
+        std::copy(data, data + record_size_, buffer_.get() + size_ * record_size_);
+        if (++size_ == capacity_) {
+            write();
+        }
+    }
+
+    /**
+     * append buffered records to dataset and trim the extent of the
+     * dataset to the number of valid records
+     */
+    void flush()
+    {
+        write();
+        if (dim_[0] > length_) {
+            set_extent(length_);
+        }
+    }
+
+    /** number of buffered records */
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    /** number of records written to the dataset, excluding buffered records */
+    hsize_t length() const
+    {
+        return length_;
+    }
+
+    /** current extent of the dataset along the outermost dimension */
+    hsize_t extent() const
+    {
+        return dim_[0];
+    }
+
+    /** maximum number of buffered records */
+    std::size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    H5::DataSet const& dataset() const
+    {
+        return dataset_;
+    }
+
+private:
+    /** write buffered records, extend dataset if necessary */
+    void write()
+    {
+        if (size_ == 0) {
+            return;
+        }
+        hsize_t required = length_ + size_;
+        if (required > dim_[0]) {
+            hsize_t extent = std::min(growth_(dim_[0], required, chunk_size_), max_length_);
+            if (extent < required) {
+                throw std::runtime_error("HDF5 writer: fixed-size dataset cannot be extended");
+            }
+            set_extent(extent);
+        }
+        detail::write_chunked_dataset<value_type, rank>(dataset_, buffer_.get(), length_, size_);
+        length_ = required;
+        size_ = 0;
+    }
+
+    /** change extent of dataset along the outermost dimension */
+    void set_extent(hsize_t extent)
+    {
+        boost::array<hsize_t, rank+1> dim = dim_;
+        dim[0] = extent;
+        herr_t err;
+        H5E_BEGIN_TRY {
+            err = H5Dset_extent(dataset_.getId(), &*dim.begin());
+        } H5E_END_TRY
+        if (err < 0) {
+            throw std::runtime_error("HDF5 writer: fixed-size dataset cannot be extended");
+        }
+        dim_[0] = extent;
+    }
+
+    H5::DataSet dataset_;
+    /** extents of dataspace, the record shape is given by dim_[1:] */
+    boost::array<hsize_t, rank+1> dim_;
+    /** number of elements per record */
+    hsize_t record_size_;
+    std::size_t capacity_;
+    std::size_t size_;
+    /** number of valid records in dataset */
+    hsize_t length_;
+    /** maximum extent of dataset along the outermost dimension */
+    hsize_t max_length_;
+    extent_growth growth_;
+    /** chunk size along the outermost dimension */
+    hsize_t chunk_size_;
+    boost::scoped_array<value_type> buffer_;
+};
+
+} // namespace h5xx
+
+#endif /* ! H5XX_CHUNKED_APPENDER_HPP */
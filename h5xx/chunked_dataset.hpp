@@ -21,6 +21,9 @@
 #define H5XX_CHUNKED_DATASET_HPP
 
 #include <h5xx/attribute.hpp>
+#include <h5xx/chunk_policy.hpp>
+#include <h5xx/convert.hpp>
+#include <h5xx/filter_pipeline.hpp>
 #include <h5xx/property.hpp>
 #include <h5xx/utility.hpp>
 
@@ -31,77 +34,75 @@
 #include <boost/utility/enable_if.hpp>
 
 #include <algorithm>
+#include <functional>
+#include <numeric>
 #include <vector>
 
 namespace h5xx {
 
-namespace detail {
+/**
+ * selection strategy for reading a range of records from a chunked dataset
+ */
+enum range_read_mode
+{
+    /** read all selected records by a single hyperslab selection */
+    read_by_hyperslab
+    /** read the selected records by one hyperslab selection per chunk */
+  , read_by_chunk
+};
 
-// http://www.hdfgroup.org/training/HDFtraining/UsersGuide/Perform.fm2.html
-// It is recommended that the chunk size be at least 8K bytes.
-enum { CHUNK_MIN_SIZE = 8092 };
+namespace detail {
 
 /**
  * create chunked dataset 'name' in given group/file with given size
  *
- * This function creates missing intermediate groups.
+ * This function creates missing intermediate groups. The shape of the
+ * chunks is chosen by the given policy, see chunk_policy, and the chunks
+ * are processed by the given filter pipeline, GZIP compression by default.
+ * An existing dataset is replaced or reused according to 'mode', see
+ * create_mode; a reused dataset of unlimited size is truncated.
  */
 // generic case: some fundamental type and a shape of arbitrary rank
 template <typename T, int rank>
-inline typename boost::enable_if<boost::is_fundamental<T>, H5::DataSet>::type
+inline typename boost::enable_if<has_ctype<T>, H5::DataSet>::type
 create_chunked_dataset(
     H5::CommonFG const& fg
   , std::string const& name
   , hsize_t const* shape
-  , hsize_t max_size=H5S_UNLIMITED)
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
     H5::IdComponent const& loc = dynamic_cast<H5::IdComponent const&>(fg);
 
     // file dataspace holding max_size multi_array chunks of fixed rank
-    boost::array<hsize_t, rank+1> dim, max_dim, chunk_dim;
+    std::vector<hsize_t> dim(rank+1), max_dim(rank+1);
     std::copy(shape, shape + rank, dim.begin() + 1);
     std::copy(shape, shape + rank, max_dim.begin() + 1);
-    std::copy(shape, shape + rank, chunk_dim.begin() + 1);
     dim[0] = (max_size == H5S_UNLIMITED) ? 0 : max_size;
     max_dim[0] = max_size;
-    chunk_dim[0] = 1;
-
-    // increase outermost dimension of chunk by powers of two until size of
-    // dataset is equal to or greater than recommended minimum chunk size
-    while (std::accumulate(chunk_dim.begin(), chunk_dim.end(), sizeof(T), std::multiplies<hsize_t>()) < CHUNK_MIN_SIZE) {
-        chunk_dim[0] *= 2;
-    }
-    chunk_dim[0] = std::min(chunk_dim[0], max_dim[0]);
+    std::vector<hsize_t> chunk_dim = policy(max_dim, sizeof(T), loc.getId());
 
     H5::DataSpace dataspace(dim.size(), &*dim.begin(), &*max_dim.begin());
-    H5::DSetCreatPropList cparms;
-    cparms.setChunk(chunk_dim.size(), &*chunk_dim.begin());
-    cparms.setDeflate(compression_level);    // enable GZIP compression
-
-    // remove dataset if it exists
-    H5E_BEGIN_TRY {
-        H5Ldelete(loc.getId(), name.c_str(), H5P_DEFAULT);
-    } H5E_END_TRY
-
-    H5::PropList pl = create_intermediate_group_property();
-    hid_t dataset_id = H5Dcreate(
-        loc.getId(), name.c_str(), ctype<T>::hid(), dataspace.getId()
-      , pl.getId(), cparms.getId(), H5P_DEFAULT
+    hid_t dataset_id = create_dataset(
+        loc.getId(), name, ctype<T>::hid(), dataspace.getId()
+      , dataset_create_property(chunk_dim, filters)->hid(), mode
     );
-    if (dataset_id < 0) {
-        throw error("failed to create dataset \"" + name + "\"");
-    }
     return H5::DataSet(dataset_id);
 }
 
 /**
  * write data to chunked dataset at given index, default argument appends to dataset
+ *
+ * The memory dataspace selects the given number of records, i.e., entries
+ * along the outermost dimension of the dataset, from 'data'.
  */
-// generic case: some fundamental type and a pointer to the contiguous array of data
-// size and shape are taken from the dataset
 template <typename T, int rank>
-inline typename boost::enable_if<boost::is_fundamental<T>, void>::type
-write_chunked_dataset(H5::DataSet const& dataset, T const* data, hsize_t index=H5S_UNLIMITED)
+inline typename boost::enable_if<has_ctype<T>, void>::type
+write_chunked_dataset(
+    H5::DataSet const& dataset, T const* data, H5::DataSpace const& mem_dataspace
+  , hsize_t index=H5S_UNLIMITED, hsize_t records=1)
 {
     H5::DataSpace dataspace(dataset.getSpace());
     if (!has_rank<rank+1>(dataspace)) {
@@ -116,11 +117,11 @@ write_chunked_dataset(H5::DataSet const& dataset, T const* data, hsize_t index=H
     std::fill(start.begin() + 1, start.end(), 0);
     std::fill(stride.begin(), stride.end(), 1);
     block = dim;
-    block[0] = 1;
+    block[0] = records;
 
     if (index == H5S_UNLIMITED) {
-        // extend dataspace to append another chunk
-        dim[0]++;
+        // extend dataspace to append further chunks
+        dim[0] += records;
         dataspace.setExtentSimple(dim.size(), &*dim.begin());
         try {
             H5XX_NO_AUTO_PRINT(H5::DataSetIException);
@@ -135,10 +136,34 @@ write_chunked_dataset(H5::DataSet const& dataset, T const* data, hsize_t index=H
     }
     dataspace.selectHyperslab(H5S_SELECT_SET, &*count.begin(), &*start.begin(), &*stride.begin(), &*block.begin());
 
+    write_data(dataset, data, mem_dataspace, dataspace);
+}
+
+/**
+ * write data to chunked dataset at given index, default argument appends to dataset
+ *
+ * The optional argument 'records' specifies the number of consecutive
+ * records (entries along the outermost dimension) stored contiguously in
+ * 'data', which are written by a single hyperslab selection.
+ */
+// generic case: some fundamental type and a pointer to the contiguous array of data
+// size and shape are taken from the dataset
+template <typename T, int rank>
+inline typename boost::enable_if<has_ctype<T>, void>::type
+write_chunked_dataset(H5::DataSet const& dataset, T const* data, hsize_t index=H5S_UNLIMITED, hsize_t records=1)
+{
+    H5::DataSpace dataspace(dataset.getSpace());
+    if (!has_rank<rank+1>(dataspace)) {
+        throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace");
+    }
+
     // memory dataspace
-    H5::DataSpace mem_dataspace(rank, block.begin() + 1);
+    boost::array<hsize_t, rank+1> dim;
+    dataspace.getSimpleExtentDims(&*dim.begin());
+    dim[0] = records;
+    H5::DataSpace mem_dataspace(rank + 1, dim.begin());
 
-    dataset.write(data, ctype<T>::hid(), mem_dataspace, dataspace);
+    write_chunked_dataset<T, rank>(dataset, data, mem_dataspace, index, records);
 }
 
 /**
@@ -147,7 +172,7 @@ write_chunked_dataset(H5::DataSet const& dataset, T const* data, hsize_t index=H
 // generic case: some (fundamental) type and a pointer to the contiguous array of data
 // size and shape are taken from the dataset
 template <typename T, int rank>
-inline typename boost::enable_if<boost::is_fundamental<T>, hsize_t>::type
+inline typename boost::enable_if<has_ctype<T>, hsize_t>::type
 read_chunked_dataset(H5::DataSet const& dataset, T* data, ssize_t index)
 {
     H5::DataSpace dataspace(dataset.getSpace());
@@ -188,30 +213,176 @@ read_chunked_dataset(H5::DataSet const& dataset, T* data, ssize_t index)
     return index;
 }
 
+/**
+ * read the records first, first + stride, …, first + (records - 1) * stride
+ * from chunked dataset
+ *
+ * The records are read by a single strided hyperslab selection into the
+ * contiguous array 'data', which must hold the given number of records.
+ * The rank of the dataset is determined at runtime and must be at least 1.
+ */
+template <typename T>
+inline typename boost::enable_if<has_ctype<T>, void>::type
+read_chunked_dataset(H5::DataSet const& dataset, T* data, hsize_t first, hsize_t records, hsize_t stride=1)
+{
+    H5::DataSpace dataspace(dataset.getSpace());
+    int const rank = dataspace.isSimple() ? dataspace.getSimpleExtentNdims() : 0;
+    if (rank < 1) {
+        throw std::runtime_error("HDF5 reader: dataset has incompatible dataspace");
+    }
+    if (stride == 0) {
+        throw std::runtime_error("HDF5 reader: stride must be positive");
+    }
+
+    std::vector<hsize_t> dim(rank);
+    dataspace.getSimpleExtentDims(&*dim.begin());
+    if (records == 0) {
+        if (first > dim[0]) {
+            throw std::runtime_error("HDF5 reader: index out of bounds");
+        }
+        return;
+    }
+    if (first >= dim[0] || (records - 1) > (dim[0] - 1 - first) / stride) {
+        throw std::runtime_error("HDF5 reader: index out of bounds");
+    }
+
+    // select 'records' blocks of a single record each
+    std::vector<hsize_t> count(rank, 1), start(rank, 0), stride_(rank, 1), block(dim);
+    start[0] = first;
+    stride_[0] = stride;
+    count[0] = records;
+    block[0] = 1;
+    dataspace.selectHyperslab(H5S_SELECT_SET, &*count.begin(), &*start.begin(), &*stride_.begin(), &*block.begin());
+
+    // memory dataspace
+    std::vector<hsize_t> mem_dim(dim);
+    mem_dim[0] = records;
+    H5::DataSpace mem_dataspace(rank, &*mem_dim.begin());
+
+    try {
+        H5XX_NO_AUTO_PRINT(H5::Exception);
+        dataset.read(data, ctype<T>::hid(), mem_dataspace, dataspace);
+    }
+    catch (H5::Exception const&) {
+        throw std::runtime_error("HDF5 reader: failed to read multidimensional array data");
+    }
+}
+
+/**
+ * read the records first, first + stride, …, first + (records - 1) * stride
+ * from chunked dataset chunk by chunk
+ *
+ * All selected records within a chunk (along the outermost dimension) are
+ * read by one strided hyperslab selection, so each chunk is decompressed
+ * exactly once independently of the chunk cache, and the library buffers
+ * are bounded by the size of a single chunk.
+ */
+template <typename T>
+inline typename boost::enable_if<has_ctype<T>, void>::type
+read_chunked_dataset_by_chunk(H5::DataSet const& dataset, T* data, hsize_t first, hsize_t records, hsize_t stride)
+{
+    H5::DSetCreatPropList cparms(dataset.getCreatePlist());
+    if (cparms.getLayout() != H5D_CHUNKED) {
+        return read_chunked_dataset(dataset, data, first, records, stride);
+    }
+
+    H5::DataSpace dataspace(dataset.getSpace());
+    int const rank = dataspace.isSimple() ? dataspace.getSimpleExtentNdims() : 0;
+    if (rank < 1) {
+        throw std::runtime_error("HDF5 reader: dataset has incompatible dataspace");
+    }
+    if (stride == 0) {
+        throw std::runtime_error("HDF5 reader: stride must be positive");
+    }
+
+    std::vector<hsize_t> dim(rank), chunk_dim(rank);
+    dataspace.getSimpleExtentDims(&*dim.begin());
+    cparms.getChunk(rank, &*chunk_dim.begin());
+    if (records == 0) {
+        if (first > dim[0]) {
+            throw std::runtime_error("HDF5 reader: index out of bounds");
+        }
+        return;
+    }
+    if (first >= dim[0] || (records - 1) > (dim[0] - 1 - first) / stride) {
+        throw std::runtime_error("HDF5 reader: index out of bounds");
+    }
+
+    // memory dataspace holding all records
+    std::vector<hsize_t> mem_dim(dim);
+    mem_dim[0] = records;
+    H5::DataSpace mem_dataspace(rank, &*mem_dim.begin());
+
+    std::vector<hsize_t> count(rank, 1), start(rank, 0), stride_(rank, 1), block(dim);
+    std::vector<hsize_t> mem_start(rank, 0), mem_block(mem_dim);
+    stride_[0] = stride;
+    block[0] = 1;
+
+    for (hsize_t i = 0; i < records; ) {
+        // select all records within the chunk containing record #i
+        hsize_t index = first + i * stride;
+        hsize_t chunk_end = (index / chunk_dim[0] + 1) * chunk_dim[0];
+        hsize_t n = std::min(records - i, (chunk_end - 1 - index) / stride + 1);
+
+        start[0] = index;
+        count[0] = n;
+        dataspace.selectHyperslab(H5S_SELECT_SET, &*count.begin(), &*start.begin(), &*stride_.begin(), &*block.begin());
+        mem_start[0] = i;
+        mem_block[0] = n;
+        mem_dataspace.selectHyperslab(H5S_SELECT_SET, &*mem_block.begin(), &*mem_start.begin());
+
+        try {
+            H5XX_NO_AUTO_PRINT(H5::Exception);
+            dataset.read(data, ctype<T>::hid(), mem_dataspace, dataspace);
+        }
+        catch (H5::Exception const&) {
+            throw std::runtime_error("HDF5 reader: failed to read multidimensional array data");
+        }
+        i += n;
+    }
+}
+
 } // namespace detail
 
 //
 // chunks of scalars
 //
 template <typename T>
-inline typename boost::enable_if<boost::is_fundamental<T>, H5::DataSet>::type
+inline typename boost::enable_if<has_ctype<T>, H5::DataSet>::type
 create_chunked_dataset(
     H5::CommonFG const& fg
   , std::string const& name
-  , hsize_t max_size=H5S_UNLIMITED)
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
-    return detail::create_chunked_dataset<T, 0>(fg, name, NULL, max_size);
+    return detail::create_chunked_dataset<T, 0>(fg, name, NULL, max_size, policy, filters, mode);
+}
+
+/** create chunked dataset for scalar records of type T, stored as type S */
+template <typename T, typename S>
+inline typename boost::enable_if<boost::mpl::and_<has_ctype<T>, has_ctype<S> >, H5::DataSet>::type
+create_chunked_dataset(
+    H5::CommonFG const& fg
+  , std::string const& name
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
+{
+    return detail::create_chunked_dataset<S, 0>(fg, name, NULL, max_size, policy, filters, mode);
 }
 
 template <typename T>
-inline typename boost::enable_if<boost::is_fundamental<T>, void>::type
+inline typename boost::enable_if<has_ctype<T>, void>::type
 write_chunked_dataset(H5::DataSet const& dataset, T const& data, hsize_t index=H5S_UNLIMITED)
 {
     detail::write_chunked_dataset<T, 0>(dataset, &data, index);
 }
 
 template <typename T>
-inline typename boost::enable_if<boost::is_fundamental<T>, hsize_t>::type
+inline typename boost::enable_if<has_ctype<T>, hsize_t>::type
 read_chunked_dataset(H5::DataSet const& dataset, T& data, ssize_t index)
 {
     return detail::read_chunked_dataset<T, 0>(dataset, &data, index);
@@ -222,22 +393,42 @@ read_chunked_dataset(H5::DataSet const& dataset, T& data, ssize_t index)
 //
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_array<T>, boost::is_fundamental<typename T::value_type>
+        is_array<T>, has_ctype<typename T::value_type>
     >, H5::DataSet>::type
 create_chunked_dataset(
     H5::CommonFG const& fg
   , std::string const& name
-  , hsize_t max_size=H5S_UNLIMITED)
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
     typedef typename T::value_type value_type;
     enum { rank = 1 };
     hsize_t shape[1] = { T::static_size };
-    return detail::create_chunked_dataset<value_type, rank>(fg, name, shape, max_size);
+    return detail::create_chunked_dataset<value_type, rank>(fg, name, shape, max_size, policy, filters, mode);
+}
+
+/** create chunked dataset for fixed-size array records of type T with elements stored as type S */
+template <typename T, typename S>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_array<T>, has_ctype<typename T::value_type>, has_ctype<S>
+    >, H5::DataSet>::type
+create_chunked_dataset(
+    H5::CommonFG const& fg
+  , std::string const& name
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
+{
+    hsize_t shape[1] = { T::static_size };
+    return detail::create_chunked_dataset<S, 1>(fg, name, shape, max_size, policy, filters, mode);
 }
 
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_array<T>, boost::is_fundamental<typename T::value_type>
+        is_array<T>, has_ctype<typename T::value_type>
     >, void>::type
 write_chunked_dataset(H5::DataSet const& dataset, T const& data, hsize_t index=H5S_UNLIMITED)
 {
@@ -252,7 +443,7 @@ write_chunked_dataset(H5::DataSet const& dataset, T const& data, hsize_t index=H
 
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_array<T>, boost::is_fundamental<typename T::value_type>
+        is_array<T>, has_ctype<typename T::value_type>
     >, hsize_t>::type
 read_chunked_dataset(H5::DataSet const& dataset, T& data, ssize_t index)
 {
@@ -270,14 +461,35 @@ create_chunked_dataset(
     H5::CommonFG const& fg
   , std::string const& name
   , typename T::size_type const* shape
-  , hsize_t max_size=H5S_UNLIMITED)
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
     typedef typename T::element value_type;
     enum { rank = T::dimensionality };
     // convert T::size_type to hsize_t
     boost::array<hsize_t, rank> shape_;
     std::copy(shape, shape + rank, shape_.begin());
-    return detail::create_chunked_dataset<value_type, rank>(fg, name, &*shape_.begin(), max_size);
+    return detail::create_chunked_dataset<value_type, rank>(fg, name, &*shape_.begin(), max_size, policy, filters, mode);
+}
+
+/** create chunked dataset for multi_array records of type T with elements stored as type S */
+template <typename T, typename S>
+inline typename boost::enable_if<boost::mpl::and_<is_multi_array<T>, has_ctype<S> >, H5::DataSet>::type
+create_chunked_dataset(
+    H5::CommonFG const& fg
+  , std::string const& name
+  , typename T::size_type const* shape
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
+{
+    enum { rank = T::dimensionality };
+    boost::array<hsize_t, rank> shape_;
+    std::copy(shape, shape + rank, shape_.begin());
+    return detail::create_chunked_dataset<S, rank>(fg, name, &*shape_.begin(), max_size, policy, filters, mode);
 }
 
 template <typename T>
@@ -293,6 +505,37 @@ write_chunked_dataset(H5::DataSet const& dataset, T const& data, hsize_t index=H
     detail::write_chunked_dataset<value_type, rank>(dataset, data.origin(), index);
 }
 
+/**
+ * write multi_array reference or view, which may have arbitrary strides,
+ * to chunked dataset
+ *
+ * Views with positive and nested strides, e.g., slices, are written
+ * without copying the data. Other views, e.g., transposed or reversed
+ * ones, are copied to a dense record first.
+ */
+template <typename T>
+inline typename boost::enable_if<is_multi_array_view<T>, void>::type
+write_chunked_dataset(H5::DataSet const& dataset, T const& data, hsize_t index=H5S_UNLIMITED)
+{
+    typedef typename T::element value_type;
+    enum { rank = T::dimensionality };
+    if (!has_extent<T, 1>(dataset, data.shape()))
+    {
+        throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace");
+    }
+    if (!detail::has_regular_strides(data)) {
+        std::vector<value_type> buffer(data.num_elements());
+        detail::gather_rows(data, 0, data.shape()[0], &*buffer.begin());
+        boost::array<hsize_t, rank> dim;
+        std::copy(data.shape(), data.shape() + rank, dim.begin());
+        detail::write_chunked_dataset<value_type, rank>(dataset, &*buffer.begin(), H5::DataSpace(rank, &*dim.begin()), index);
+        return;
+    }
+    value_type const* base;
+    H5::DataSpace mem_dataspace = detail::memory_dataspace(data, base);
+    detail::write_chunked_dataset<value_type, rank>(dataset, base, mem_dataspace, index);
+}
+
 /** read chunk of multi_array data, resize/reshape result array if necessary */
 template <typename T>
 inline typename boost::enable_if<is_multi_array<T>, hsize_t>::type
@@ -325,22 +568,43 @@ read_chunked_dataset(H5::DataSet const& dataset, T& data, ssize_t index)
 // pass length of vector as third parameter
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_vector<T>, boost::is_fundamental<typename T::value_type>
+        is_vector<T>, has_ctype<typename T::value_type>
     >, H5::DataSet>::type
 create_chunked_dataset(
     H5::CommonFG const& fg
   , std::string const& name
   , typename T::size_type size
-  , hsize_t max_size=H5S_UNLIMITED)
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
     typedef typename T::value_type value_type;
     hsize_t shape[1] = { size };
-    return detail::create_chunked_dataset<value_type, 1>(fg, name, shape, max_size);
+    return detail::create_chunked_dataset<value_type, 1>(fg, name, shape, max_size, policy, filters, mode);
+}
+
+/** create chunked dataset for vector records of type T with elements stored as type S */
+template <typename T, typename S>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, has_ctype<typename T::value_type>, has_ctype<S>
+    >, H5::DataSet>::type
+create_chunked_dataset(
+    H5::CommonFG const& fg
+  , std::string const& name
+  , typename T::size_type size
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
+{
+    hsize_t shape[1] = { size };
+    return detail::create_chunked_dataset<S, 1>(fg, name, shape, max_size, policy, filters, mode);
 }
 
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_vector<T>, boost::is_fundamental<typename T::value_type>
+        is_vector<T>, has_ctype<typename T::value_type>
     >, void>::type
 write_chunked_dataset(H5::DataSet const& dataset, T const& data, hsize_t index=H5S_UNLIMITED)
 {
@@ -361,7 +625,7 @@ write_chunked_dataset(H5::DataSet const& dataset, T const& data, hsize_t index=H
 /** read chunk of vector container with scalar data, resize/reshape result array if necessary */
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_vector<T>, boost::is_fundamental<typename T::value_type>
+        is_vector<T>, has_ctype<typename T::value_type>
     >, hsize_t>::type
 read_chunked_dataset(H5::DataSet const& dataset, T& data, ssize_t index)
 {
@@ -391,12 +655,33 @@ create_chunked_dataset(
     H5::CommonFG const& fg
   , std::string const& name
   , typename T::size_type size
-  , hsize_t max_size=H5S_UNLIMITED)
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
     typedef typename T::value_type array_type;
     typedef typename array_type::value_type value_type;
     hsize_t shape[2] = { size, array_type::static_size };
-    return detail::create_chunked_dataset<value_type, 2>(fg, name, shape, max_size);
+    return detail::create_chunked_dataset<value_type, 2>(fg, name, shape, max_size, policy, filters, mode);
+}
+
+/** create chunked dataset for records of vectors of arrays of type T with elements stored as type S */
+template <typename T, typename S>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, is_array<typename T::value_type>, has_ctype<S>
+    >, H5::DataSet>::type
+create_chunked_dataset(
+    H5::CommonFG const& fg
+  , std::string const& name
+  , typename T::size_type size
+  , hsize_t max_size=H5S_UNLIMITED
+  , chunk_policy const& policy=chunk_policy()
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
+{
+    hsize_t shape[2] = { size, T::value_type::static_size };
+    return detail::create_chunked_dataset<S, 2>(fg, name, shape, max_size, policy, filters, mode);
 }
 
 template <typename T>
@@ -444,6 +729,270 @@ read_chunked_dataset(H5::DataSet const& dataset, T& data, ssize_t index)
     return detail::read_chunked_dataset<value_type, 2>(dataset, &*data.begin()->begin(), index);
 }
 
+//
+// ranges of records
+//
+// The records first, first + stride, …, first + (count - 1) * stride are read
+// by a single library call, which lets HDF5 decompress each chunk only once.
+// Alternatively, the records are read by one call per chunk, see
+// range_read_mode.
+//
+
+namespace detail {
+
+template <typename T>
+inline void read_chunked_dataset(
+    H5::DataSet const& dataset, T* data
+  , hsize_t first, hsize_t count, hsize_t stride, range_read_mode mode)
+{
+    if (mode == read_by_chunk) {
+        read_chunked_dataset_by_chunk(dataset, data, first, count, stride);
+    }
+    else {
+        read_chunked_dataset(dataset, data, first, count, stride);
+    }
+}
+
+} // namespace detail
+
+/** read range of records of any shape into contiguous array of sufficient size */
+template <typename T>
+inline typename boost::enable_if<has_ctype<T>, void>::type
+read_chunked_dataset(
+    H5::DataSet const& dataset, T* data
+  , hsize_t first, hsize_t count, hsize_t stride=1, range_read_mode mode=read_by_hyperslab)
+{
+    detail::read_chunked_dataset(dataset, data, first, count, stride, mode);
+}
+
+/** read range of scalar records into vector container, resize result vector */
+template <typename T>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, has_ctype<typename T::value_type>
+    >, void>::type
+read_chunked_dataset(
+    H5::DataSet const& dataset, T& data
+  , hsize_t first, hsize_t count, hsize_t stride=1, range_read_mode mode=read_by_hyperslab)
+{
+    if (!has_rank<1>(dataset)) {
+        throw std::runtime_error("HDF5 reader: dataset has incompatible dataspace");
+    }
+    data.resize(count);
+    detail::read_chunked_dataset(dataset, count > 0 ? &*data.begin() : NULL, first, count, stride, mode);
+}
+
+/** read range of fixed-size array records into vector container, resize result vector */
+template <typename T>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, is_array<typename T::value_type>
+    >, void>::type
+read_chunked_dataset(
+    H5::DataSet const& dataset, T& data
+  , hsize_t first, hsize_t count, hsize_t stride=1, range_read_mode mode=read_by_hyperslab)
+{
+    typedef typename T::value_type array_type;
+    if (!has_extent<array_type, 1>(dataset)) {
+        throw std::runtime_error("HDF5 reader: dataset has incompatible dataspace");
+    }
+    data.resize(count);
+    // raw data are laid out contiguously
+    detail::read_chunked_dataset(dataset, count > 0 ? &*data.begin()->begin() : NULL, first, count, stride, mode);
+}
+
+/**
+ * read range of records into multi_array of rank equal to the dataset,
+ * i.e., one more than the records, resize/reshape result array if necessary
+ */
+template <typename T>
+inline typename boost::enable_if<is_multi_array<T>, void>::type
+read_chunked_dataset(
+    H5::DataSet const& dataset, T& data
+  , hsize_t first, hsize_t count, hsize_t stride=1, range_read_mode mode=read_by_hyperslab)
+{
+    enum { rank = T::dimensionality };
+
+    // determine extent of data space
+    H5::DataSpace dataspace(dataset.getSpace());
+    if (!has_rank<rank>(dataspace)) {
+        throw std::runtime_error("HDF5 reader: dataset has incompatible dataspace");
+    }
+    boost::array<hsize_t, rank> dim;
+    dataspace.getSimpleExtentDims(&*dim.begin());
+    dim[0] = count;
+
+    // resize result array if necessary, may allocate new memory
+    if (!std::equal(dim.begin(), dim.end(), data.shape())) {
+        boost::array<size_t, rank> shape;
+        std::copy(dim.begin(), dim.end(), shape.begin());
+        data.resize(shape);
+    }
+
+    detail::read_chunked_dataset(dataset, data.origin(), first, count, stride, mode);
+}
+
+/**
+ * Typed handle of a chunked dataset of records of type T
+ *
+ * The handle validates rank and shape of the dataset upon construction
+ * and keeps the native data type, the file and memory dataspaces, and the
+ * extent of the dataset. Repeated reads and writes thus neither query the
+ * dataset's metadata nor create new HDF5 objects. The record type T is any
+ * type supported by write_chunked_dataset().
+ *
+ * The handle determines the storage type of the dataset once and converts
+ * records of double or single precision to a reduced-precision storage
+ * type by the kernels of h5xx, see create_chunked_dataset<T, S>(), into a
+ * buffer that is kept between writes.
+ *
+ * The cached extent assumes that the dataset is extended only through
+ * this handle; call refresh() after the dataset was modified otherwise.
+ */
+template <typename T>
+class chunked_dataset
+{
+private:
+    typedef detail::record_traits<T> traits_type;
+
+public:
+    typedef T record_type;
+    typedef typename traits_type::value_type value_type;
+    enum { rank = traits_type::rank };
+
+    explicit chunked_dataset(H5::DataSet const& dataset)
+      : dataset_(dataset)
+      , file_space_(dataset.getSpace())
+    {
+        if (!has_rank<rank+1>(file_space_)) {
+            throw std::runtime_error("HDF5 chunked dataset: dataset has incompatible dataspace");
+        }
+        file_space_.getSimpleExtentDims(&*dim_.begin());
+        if (!traits_type::is_valid_shape(&*dim_.begin() + 1)) {
+            throw std::runtime_error("HDF5 chunked dataset: dataset has incompatible dataspace");
+        }
+
+        type_ = H5::DataType(ctype<value_type>::hid());
+        storage_ = detail::storage_of(dataset_);
+
+        // hyperslab and memory dataspace of a single record
+        std::fill(start_.begin(), start_.end(), 0);
+        std::fill(count_.begin(), count_.end(), 1);
+        block_ = dim_;
+        block_[0] = 1;
+        mem_space_ = H5::DataSpace(rank + 1, &*block_.begin());
+    }
+
+    /**
+     * write record at given index, default argument appends to dataset
+     */
+    void write(T const& record, hsize_t index=H5S_UNLIMITED)
+    {
+        if (!traits_type::has_shape(record, &*dim_.begin() + 1)) {
+            throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace");
+        }
+        if (index == H5S_UNLIMITED) {
+            index = dim_[0];
+            set_extent(index + 1);
+        }
+        else if (index >= dim_[0]) {
+            throw std::runtime_error("HDF5 writer: index out of bounds");
+        }
+        select(index);
+        detail::write_data(dataset_, traits_type::data(record), mem_space_, file_space_, storage_, buffer_);
+    }
+
+    /**
+     * read record at given index, negative values count from the end,
+     * resize record if necessary
+     *
+     * Returns the non-negative index of the record.
+     */
+    hsize_t read(T& record, ssize_t index) const
+    {
+        ssize_t const len = dim_[0];
+        if ((index >= len) || ((-index) > len)) {
+            throw std::runtime_error("HDF5 reader: index out of bounds");
+        }
+        index = (index < 0) ? (index + len) : index;
+
+        traits_type::resize(record, &*dim_.begin() + 1);
+        select(index);
+        herr_t err;
+        H5E_BEGIN_TRY {
+            err = H5Dread(
+                dataset_.getId(), type_.getId(), mem_space_.getId(), file_space_.getId()
+              , H5P_DEFAULT, traits_type::data(record)
+            );
+        } H5E_END_TRY
+        if (err < 0) {
+            throw std::runtime_error("HDF5 reader: failed to read multidimensional array data");
+        }
+        return index;
+    }
+
+    /** number of records in dataset */
+    hsize_t size() const
+    {
+        return dim_[0];
+    }
+
+    /** shape of a record */
+    hsize_t const* shape() const
+    {
+        return &*dim_.begin() + 1;
+    }
+
+    /** re-read extent of dataset */
+    void refresh()
+    {
+        file_space_ = dataset_.getSpace();
+        file_space_.getSimpleExtentDims(&*dim_.begin());
+    }
+
+    H5::DataSet const& dataset() const
+    {
+        return dataset_;
+    }
+
+private:
+    /** select record in file dataspace */
+    void select(hsize_t index) const
+    {
+        start_[0] = index;
+        file_space_.selectHyperslab(H5S_SELECT_SET, &*count_.begin(), &*start_.begin(), NULL, &*block_.begin());
+    }
+
+    /** change extent of dataset along the outermost dimension */
+    void set_extent(hsize_t extent)
+    {
+        boost::array<hsize_t, rank+1> dim = dim_;
+        dim[0] = extent;
+        herr_t err;
+        H5E_BEGIN_TRY {
+            err = H5Dset_extent(dataset_.getId(), &*dim.begin());
+        } H5E_END_TRY
+        if (err < 0) {
+            throw std::runtime_error("HDF5 writer: fixed-size dataset cannot be extended");
+        }
+        file_space_.setExtentSimple(dim.size(), &*dim.begin());
+        dim_[0] = extent;
+    }
+
+    H5::DataSet dataset_;
+    H5::DataType type_;
+    /** reduced-precision storage type, converted to upon writing */
+    detail::storage_type storage_;
+    /** converted record */
+    std::vector<char> buffer_;
+    mutable H5::DataSpace file_space_;
+    H5::DataSpace mem_space_;
+    /** extents of dataspace, the record shape is given by dim_[1:] */
+    boost::array<hsize_t, rank+1> dim_;
+    /** hyperslab parameters of a single record */
+    mutable boost::array<hsize_t, rank+1> start_;
+    boost::array<hsize_t, rank+1> count_;
+    boost::array<hsize_t, rank+1> block_;
+};
+
 } // namespace h5xx
 
 #endif /* ! H5XX_CHUNKED_DATASET_HPP */
@@ -0,0 +1,297 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H5XX_CONVERT_HPP
+#define H5XX_CONVERT_HPP
+
+#include <h5xx/ctype.hpp>
+#include <h5xx/hdf5_compat.hpp>
+#include <h5xx/lru_cache.hpp>
+
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/is_floating_point.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(__F16C__)
+# include <immintrin.h>
+#endif
+
+namespace h5xx {
+namespace detail {
+
+//
+// Conversion kernels from the in-memory to a reduced-precision storage type
+//
+// The kernels round to nearest, ties to even, as by IEEE 754 and the SSE2
+// and F16C instructions, which are used if enabled at compile time, e.g., by
+// -msse2 or -mf16c (or -march=native). Note that the software conversion of
+// the HDF5 library to half precision rounds ties away from zero.
+//
+
+/** convert double to single precision */
+inline void convert(double const* in, float* out, std::size_t n)
+{
+    std::size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 4 <= n; i += 4) {
+        __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(in + i));
+        __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(in + i + 2));
+        _mm_storeu_ps(out + i, _mm_movelh_ps(lo, hi));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = static_cast<float>(in[i]);
+    }
+}
+
+/** convert single to half precision, scalar version */
+inline boost::uint16_t float_to_half(float value)
+{
+    boost::uint32_t x;
+    std::memcpy(&x, &value, sizeof(x));
+    boost::uint32_t sign = (x >> 16) & 0x8000;
+    boost::uint32_t abs = x & 0x7fffffff;
+
+    if (abs >= 0x7f800000) {
+        // infinity or NaN, keep NaN quiet
+        return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 | ((abs >> 13) & 0x3ff) : 0);
+    }
+    if (abs >= 0x477ff000) {
+        // overflow: values from 65520 on round to infinity
+        return sign | 0x7c00;
+    }
+    if (abs < 0x38800000) {
+        // subnormal half-precision number or zero
+        if (abs < 0x33000000) {
+            return sign;
+        }
+        boost::uint32_t exponent = abs >> 23;
+        boost::uint32_t mantissa = (abs & 0x7fffff) | 0x800000;
+        unsigned int shift = 126 - exponent;
+        boost::uint32_t h = mantissa >> shift;
+        boost::uint32_t remainder = mantissa & ((1U << shift) - 1);
+        boost::uint32_t halfway = 1U << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (h & 1))) {
+            ++h;
+        }
+        return sign | h;
+    }
+    // normal number: rebias exponent from 127 to 15, round mantissa to 10 bits,
+    // a carry propagates into the exponent correctly
+    boost::uint32_t h = (abs - 0x38000000) >> 13;
+    boost::uint32_t remainder = abs & 0x1fff;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (h & 1))) {
+        ++h;
+    }
+    return sign | h;
+}
+
+/** convert single to half precision */
+inline void convert(float const* in, half* out, std::size_t n)
+{
+    std::size_t i = 0;
+#ifdef __F16C__
+    for (; i + 4 <= n; i += 4) {
+        __m128i h = _mm_cvtps_ph(_mm_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), h);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i].bits = float_to_half(in[i]);
+    }
+}
+
+/**
+ * convert double to half precision via single precision
+ *
+ * The intermediate rounding to single precision may differ from direct
+ * rounding in the last bit for values very close to a tie.
+ */
+inline void convert(double const* in, half* out, std::size_t n)
+{
+    float buffer[256];
+    for (std::size_t i = 0; i < n; i += 256) {
+        std::size_t m = std::min(n - i, std::size_t(256));
+        convert(in + i, buffer, m);
+        convert(buffer, out + i, m);
+    }
+}
+
+/**
+ * floating-point storage types, to which h5xx converts itself
+ */
+enum storage_type
+{
+    store_native
+  , store_float
+  , store_half
+};
+
+/** determine storage type of floating-point dataset */
+inline storage_type storage_of(H5::DataSet const& dataset)
+{
+    hid_t type = H5Dget_type(dataset.getId());
+    if (type < 0) {
+        throw error("failed to get data type of dataset");
+    }
+    storage_type storage = store_native;
+    if (H5Tget_class(type) == H5T_FLOAT) {
+        if (H5Tequal(type, ctype<float>::hid()) > 0) {
+            storage = store_float;
+        }
+        else if (H5Tequal(type, ctype<half>::hid()) > 0) {
+            storage = store_half;
+        }
+    }
+    H5Tclose(type);
+    return storage;
+}
+
+/**
+ * storage type of dataset, determined once per dataset
+ *
+ * The storage types are cached by dataset id for the most recently written
+ * datasets. The HDF5 library does not reuse the ids of closed objects.
+ */
+inline storage_type cached_storage_of(H5::DataSet const& dataset)
+{
+    static lru_cache<hid_t, storage_type> cache(1024);
+    storage_type storage;
+    if (!cache.find(dataset.getId(), storage)) {
+        storage = cache.insert(dataset.getId(), storage_of(dataset));
+    }
+    return storage;
+}
+
+/**
+ * convert data of memory dataspace to type S and write to dataset
+ *
+ * 'buffer' receives the converted data and grows as needed, so that its
+ * memory is reused by repeated writes. For partial selections of the
+ * memory dataspace, e.g., of strided data, all elements from the first to
+ * the last selected one are converted.
+ */
+template <typename S, typename T>
+inline void write_converted(
+    H5::DataSet const& dataset, T const* data
+  , H5::DataSpace const& mem_space, H5::DataSpace const& file_space
+  , std::vector<char>& buffer)
+{
+    hssize_t selected = mem_space.getSelectNpoints();
+    if (selected == 0) {
+        dataset.write(data, ctype<T>::hid(), mem_space, file_space);
+        return;
+    }
+    std::size_t first = 0;
+    std::size_t last = mem_space.getSimpleExtentNpoints();
+    if (selected != hssize_t(last)) {
+        // row-major offsets of the corners of the bounding box
+        int rank = mem_space.getSimpleExtentNdims();
+        std::vector<hsize_t> dim(rank), lower(rank), upper(rank);
+        mem_space.getSimpleExtentDims(&*dim.begin());
+        mem_space.getSelectBounds(&*lower.begin(), &*upper.begin());
+        first = lower[0];
+        last = upper[0];
+        for (int i = 1; i < rank; ++i) {
+            first = first * dim[i] + lower[i];
+            last = last * dim[i] + upper[i];
+        }
+        ++last;
+    }
+    if (buffer.size() < last * sizeof(S)) {
+        buffer.resize(last * sizeof(S));
+    }
+    S* converted = reinterpret_cast<S*>(&*buffer.begin());
+    convert(data + first, converted + first, last - first);
+    dataset.write(converted, ctype<S>::hid(), mem_space, file_space);
+}
+
+/**
+ * write data to dataset, converting from double or single precision to the
+ * given reduced-precision storage type by the above kernels, and leaving
+ * any other conversion to the HDF5 library
+ *
+ * The data buffer must cover the extent of the memory dataspace, or the
+ * range from the first to the last selected element for partial
+ * selections. 'buffer' receives the converted data, see write_converted().
+ */
+template <typename T>
+inline void write_data(
+    H5::DataSet const& dataset, T const* data
+  , H5::DataSpace const& mem_space, H5::DataSpace const& file_space
+  , storage_type, std::vector<char>&)
+{
+    dataset.write(data, ctype<T>::hid(), mem_space, file_space);
+}
+
+inline void write_data(
+    H5::DataSet const& dataset, double const* data
+  , H5::DataSpace const& mem_space, H5::DataSpace const& file_space
+  , storage_type storage, std::vector<char>& buffer)
+{
+    switch (storage) {
+      case store_float:
+        write_converted<float>(dataset, data, mem_space, file_space, buffer);
+        break;
+      case store_half:
+        write_converted<half>(dataset, data, mem_space, file_space, buffer);
+        break;
+      default:
+        dataset.write(data, ctype<double>::hid(), mem_space, file_space);
+    }
+}
+
+inline void write_data(
+    H5::DataSet const& dataset, float const* data
+  , H5::DataSpace const& mem_space, H5::DataSpace const& file_space
+  , storage_type storage, std::vector<char>& buffer)
+{
+    if (storage == store_half) {
+        write_converted<half>(dataset, data, mem_space, file_space, buffer);
+    }
+    else {
+        dataset.write(data, ctype<float>::hid(), mem_space, file_space);
+    }
+}
+
+/**
+ * write data to dataset, converting floating-point data to the storage
+ * type of the dataset as above
+ *
+ * The storage type is looked up in the cache of cached_storage_of(), so
+ * that data written by the free functions and by the dataset handles are
+ * converted alike.
+ */
+template <typename T>
+inline void write_data(
+    H5::DataSet const& dataset, T const* data
+  , H5::DataSpace const& mem_space, H5::DataSpace const& file_space)
+{
+    std::vector<char> buffer;
+    storage_type storage = boost::is_floating_point<T>::value ? cached_storage_of(dataset) : store_native;
+    write_data(dataset, data, mem_space, file_space, storage, buffer);
+}
+
+} // namespace detail
+} // namespace h5xx
+
+#endif /* ! H5XX_CONVERT_HPP */
@@ -20,25 +20,105 @@
 #ifndef H5XX_CTYPE_HPP
 #define H5XX_CTYPE_HPP
 
+#include <h5xx/error.hpp>
 #include <h5xx/hdf5_compat.hpp>
 
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/stringize.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_fundamental.hpp>
+
+#include <cstddef>
+
 namespace h5xx {
+
+/**
+ * true for types with an HDF5 native data type, i.e., fundamental types
+ * and structs registered by H5XX_COMPOUND_TYPE
+ */
+template <typename T>
+struct has_ctype
+  : boost::is_fundamental<T> {};
+
+/**
+ * IEEE 754 half-precision floating-point number in native byte order
+ *
+ * The type serves as storage type of datasets holding single or double
+ * precision data, see create_dataset() and create_chunked_dataset();
+ * h5xx provides no arithmetic.
+ */
+struct half
+{
+    boost::uint16_t bits;
+};
+
+template <>
+struct has_ctype<half>
+  : boost::true_type {};
+
 namespace detail {
 
+/**
+ * HDF5 data type, which is kept open until program exit
+ */
+class type_handle
+{
+public:
+    /** take ownership of data type id */
+    explicit type_handle(hid_t hid)
+      : hid_(hid)
+    {
+        if (hid_ < 0) {
+            throw error("failed to create HDF5 data type");
+        }
+    }
+
+    ~type_handle()
+    {
+        // the HDF5 library may have been shut down already
+        H5E_BEGIN_TRY {
+            H5Tclose(hid_);
+        } H5E_END_TRY
+    }
+
+    hid_t hid() const
+    {
+        return hid_;
+    }
+
+private:
+    type_handle(type_handle const&);
+    type_handle& operator=(type_handle const&);
+
+    hid_t const hid_;
+};
+
 /*
  * Translate C/C++ type to HDF5 native data type.
+ *
+ * hid() returns the same data type id on every call, which is created upon
+ * the first call and released at program exit. The id must neither be
+ * closed nor modified by the caller; wrapping it in H5::DataType is safe,
+ * since the wrapper holds its own reference.
+ *
+ * The id is created upon first use as a function-local static object,
+ * whose initialisation is thread-safe with GCC and Clang (and by virtue
+ * of the standard since C++11).
  */
 template <typename T>
 struct ctype;
 
-#define H5XX_MAKE_CTYPE(T, H5T)         \
-    template <>                         \
-    struct ctype<T>                     \
-    {                                   \
-        static hid_t hid()              \
-        {                               \
-            return H5Tcopy(H5T);        \
-        }                               \
+#define H5XX_MAKE_CTYPE(T, H5T)                             \
+    template <>                                             \
+    struct ctype<T>                                         \
+    {                                                       \
+        static hid_t hid()                                  \
+        {                                                   \
+            static type_handle const type(H5Tcopy(H5T));    \
+            return type.hid();                              \
+        }                                                   \
     }
 
 H5XX_MAKE_CTYPE( char,                  H5T_NATIVE_CHAR );
@@ -59,7 +139,130 @@ H5XX_MAKE_CTYPE( bool,                  H5T_NATIVE_CHAR ); // ignore unsupported
 
 #undef H5XX_MAKE_CTYPE
 
+template <>
+struct ctype<half>
+{
+    static hid_t hid()
+    {
+        static type_handle const type(create());
+        return type.hid();
+    }
+
+    /** derive 16-bit type from native float: sign bit, 5 exponent and 10 mantissa bits */
+    static hid_t create()
+    {
+        hid_t type = H5Tcopy(H5T_NATIVE_FLOAT);
+        if (type < 0
+            || H5Tset_fields(type, 15, 10, 5, 0, 10) < 0
+            || H5Tset_size(type, 2) < 0
+            || H5Tset_ebias(type, 15) < 0) {
+            throw error("failed to create half-precision data type");
+        }
+        return type;
+    }
+};
+
+/**
+ * HDF5 data type of a member of a compound type: a type with a native data
+ * type, or a fixed-size array thereof, i.e., T[N] or boost::array<T, N>
+ */
+template <typename T>
+struct member_ctype
+{
+    static hid_t hid()
+    {
+        return ctype<T>::hid();
+    }
+};
+
+template <typename T, std::size_t N>
+struct member_ctype<T[N]>
+{
+    static hid_t hid()
+    {
+        hsize_t dim[1] = { N };
+        static type_handle const type(H5Tarray_create(member_ctype<T>::hid(), 1, dim));
+        return type.hid();
+    }
+};
+
+template <typename T, std::size_t N>
+struct member_ctype<boost::array<T, N> >
+  : member_ctype<T[N]> {};
+
+/**
+ * insert member of type M at given offset into compound type, the pointer
+ * to member serves to deduce the type only
+ */
+template <typename S, typename M>
+inline void insert_member(hid_t type, char const* name, std::size_t offset, M S::*)
+{
+    if (H5Tinsert(type, name, offset, member_ctype<M>::hid()) < 0) {
+        throw error(std::string("failed to insert member \"") + name + "\" into compound type");
+    }
+}
+
+/** create compound type of given size, members are added by 'insert' */
+template <typename S>
+inline hid_t create_compound_type(void (*insert)(hid_t))
+{
+    hid_t type = H5Tcreate(H5T_COMPOUND, sizeof(S));
+    if (type < 0) {
+        throw error("failed to create compound type");
+    }
+    try {
+        insert(type);
+    }
+    catch (...) {
+        H5Tclose(type);
+        throw;
+    }
+    return type;
+}
+
 } // namespace detail
 } // namespace h5xx
 
+#define H5XX_COMPOUND_MEMBER(r, S, member)                                      \
+    ::h5xx::detail::insert_member(type, BOOST_PP_STRINGIZE(member), HOFFSET(S, member), &S::member);
+
+/**
+ * Register a POD struct S as HDF5 compound type with the given sequence of
+ * members, e.g.,
+ *
+ *     struct particle { double position[3]; double velocity[3]; int species; };
+ *     H5XX_COMPOUND_TYPE( particle, (position)(velocity)(species) )
+ *
+ * The members are stored under their names in the file. Members may be of
+ * fundamental type, of a registered compound type, or fixed-size arrays
+ * thereof, either C arrays or boost::array. Members not listed are not
+ * stored. The struct may then be used wherever h5xx accepts fundamental
+ * types, in particular as element of std::vector, which is read and
+ * written as a contiguous buffer.
+ *
+ * The macro must be used at global scope, S may be a qualified name.
+ */
+#define H5XX_COMPOUND_TYPE(S, members)                                          \
+    namespace h5xx {                                                            \
+    template <>                                                                 \
+    struct has_ctype<S>                                                         \
+      : boost::true_type {};                                                    \
+    namespace detail {                                                          \
+    template <>                                                                 \
+    struct ctype<S>                                                             \
+    {                                                                           \
+        static hid_t hid()                                                      \
+        {                                                                       \
+            static type_handle const type(create_compound_type<S>(&insert));    \
+            return type.hid();                                                  \
+        }                                                                       \
+                                                                                \
+        static void insert(hid_t type)                                          \
+        {                                                                       \
+            BOOST_PP_SEQ_FOR_EACH(H5XX_COMPOUND_MEMBER, S, members)             \
+        }                                                                       \
+    };                                                                          \
+    } /* namespace detail */                                                    \
+    } /* namespace h5xx */
+
 #endif /* ! H5XX_CTYPE_HPP */
@@ -21,6 +21,9 @@
 #define H5XX_DATASET_HPP
 
 #include <h5xx/attribute.hpp>
+#include <h5xx/chunk_policy.hpp>
+#include <h5xx/convert.hpp>
+#include <h5xx/filter_pipeline.hpp>
 #include <h5xx/property.hpp>
 #include <h5xx/utility.hpp>
 
@@ -30,6 +33,8 @@
 #include <boost/type_traits.hpp>
 #include <boost/utility/enable_if.hpp>
 
+#include <functional>
+#include <numeric>
 #include <vector>
 
 namespace h5xx {
@@ -40,39 +45,39 @@ namespace detail {
  * Create dataset 'name' in given group/file. The dataset contains
  * a single entry only and should be written via write_dataset().
  *
- * This function creates missing intermediate groups.
+ * This function creates missing intermediate groups. Datasets of at least
+ * 64 bytes are split into chunks of the given policy, tiles of at most 1 MiB
+ * by default, which are processed by the given filter pipeline. For an
+ * empty pipeline, the dataset is stored contiguously, so that partial
+ * reads touch only the selected data. An existing dataset is replaced or
+ * reused according to 'mode', see create_mode.
  */
 // generic case: some fundamental type and a shape of arbitrary rank
 template <typename T, int rank>
-inline typename boost::enable_if<boost::is_fundamental<T>, H5::DataSet>::type
+inline typename boost::enable_if<has_ctype<T>, H5::DataSet>::type
 create_dataset(
     H5::CommonFG const& fg
   , std::string const& name
-  , hsize_t const* shape)
+  , hsize_t const* shape
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing
+  , chunk_policy const& policy=chunk_policy::tiles())
 {
     H5::IdComponent const& loc = dynamic_cast<H5::IdComponent const&>(fg);
 
     // file dataspace holding a single multi_array of fixed rank
     H5::DataSpace dataspace(rank, shape);
-    H5::DSetCreatPropList cparms;
-    if (rank > 0 && sizeof(T) * shape[0] > 64) { // enable GZIP compression for at least 64 bytes
-        cparms.setChunk(rank, shape);
-        cparms.setDeflate(compression_level);
+    std::vector<hsize_t> dim(shape, shape + rank);
+    std::vector<hsize_t> chunk_dim; // contiguous layout
+    hsize_t size = std::accumulate(dim.begin(), dim.end(), hsize_t(sizeof(T)), std::multiplies<hsize_t>());
+    if (rank > 0 && size > 64 && !filters.empty()) { // enable filters for at least 64 bytes
+        chunk_dim = policy(dim, sizeof(T), loc.getId());
     }
 
-    // remove dataset if it exists
-    H5E_BEGIN_TRY {
-        H5Ldelete(loc.getId(), name.c_str(), H5P_DEFAULT);
-    } H5E_END_TRY
-
-    H5::PropList pl = create_intermediate_group_property();
-    hid_t dataset_id = H5Dcreate(
-        loc.getId(), name.c_str(), ctype<T>::hid(), dataspace.getId()
-      , pl.getId(), cparms.getId(), H5P_DEFAULT
+    hid_t dataset_id = create_dataset(
+        loc.getId(), name, ctype<T>::hid(), dataspace.getId()
+      , dataset_create_property(chunk_dim, filters)->hid(), mode
     );
-    if (dataset_id < 0) {
-        throw error("failed to create dataset \"" + name + "\"");
-    }
     return H5::DataSet(dataset_id);
 }
 
@@ -82,14 +87,14 @@ create_dataset(
 // generic case: some fundamental type and a pointer to the contiguous array of data
 // size and shape are taken from the dataset
 template <typename T, int rank>
-inline typename boost::enable_if<boost::is_fundamental<T>, void>::type
+inline typename boost::enable_if<has_ctype<T>, void>::type
 write_dataset(H5::DataSet const& dataset, T const* data)
 {
     H5::DataSpace dataspace(dataset.getSpace());
     if (!has_rank<rank>(dataspace)) {
         throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace");
     }
-    dataset.write(data, ctype<T>::hid(), dataspace, dataspace);
+    write_data(dataset, data, dataspace, dataspace);
 }
 
 /**
@@ -98,7 +103,7 @@ write_dataset(H5::DataSet const& dataset, T const* data)
 // generic case: some (fundamental) type and a pointer to the contiguous array of data
 // size and shape are taken from the dataset
 template <typename T, int rank>
-inline typename boost::enable_if<boost::is_fundamental<T>, void>::type
+inline typename boost::enable_if<has_ctype<T>, void>::type
 read_dataset(H5::DataSet const& dataset, T* data)
 {
     H5::DataSpace dataspace(dataset.getSpace());
@@ -114,29 +119,107 @@ read_dataset(H5::DataSet const& dataset, T* data)
     }
 }
 
+/**
+ * select hyperslab of given offset and count in dataspace of dataset,
+ * return false if it exceeds the extent of the dataset
+ */
+template <int rank>
+inline bool select_hyperslab(H5::DataSpace& dataspace, hsize_t const* offset, hsize_t const* count)
+{
+    if (!has_rank<rank>(dataspace)) {
+        return false;
+    }
+    boost::array<hsize_t, rank> dim;
+    dataspace.getSimpleExtentDims(&*dim.begin());
+    for (int i = 0; i < rank; ++i) {
+        if (offset[i] > dim[i] || count[i] > dim[i] - offset[i]) {
+            return false;
+        }
+    }
+    dataspace.selectHyperslab(H5S_SELECT_SET, count, offset);
+    return true;
+}
+
+/**
+ * write block of data to dataset, starting at given offset
+ *
+ * 'data' points to the contiguous array holding the block, whose shape is
+ * given by 'count'. Blocks owned by different parts of a program are
+ * written to disjoint regions of the dataset without gathering the data.
+ */
+template <typename T, int rank>
+inline typename boost::enable_if<has_ctype<T>, void>::type
+write_dataset(H5::DataSet const& dataset, T const* data, hsize_t const* offset, hsize_t const* count)
+{
+    H5::DataSpace dataspace(dataset.getSpace());
+    if (!select_hyperslab<rank>(dataspace, offset, count)) {
+        throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace");
+    }
+    H5::DataSpace mem_dataspace(rank, count);
+    write_data(dataset, data, mem_dataspace, dataspace);
+}
+
+/**
+ * read block of data from dataset, starting at given offset
+ *
+ * 'data' points to the contiguous array receiving the block, whose shape
+ * is given by 'count'.
+ */
+template <typename T, int rank>
+inline typename boost::enable_if<has_ctype<T>, void>::type
+read_dataset(H5::DataSet const& dataset, T* data, hsize_t const* offset, hsize_t const* count)
+{
+    H5::DataSpace dataspace(dataset.getSpace());
+    if (!select_hyperslab<rank>(dataspace, offset, count)) {
+        throw std::runtime_error("HDF5 reader: dataset has incompatible dataspace");
+    }
+    H5::DataSpace mem_dataspace(rank, count);
+    try {
+        H5XX_NO_AUTO_PRINT(H5::Exception);
+        dataset.read(data, ctype<T>::hid(), mem_dataspace, dataspace);
+    }
+    catch (H5::Exception const&) {
+        throw std::runtime_error("HDF5 reader: failed to read multidimensional array data");
+    }
+}
+
 } // namespace detail
 
 //
 // scalar/fundamental types
 //
 template <typename T>
-inline typename boost::enable_if<boost::is_fundamental<T>, H5::DataSet>::type
+inline typename boost::enable_if<has_ctype<T>, H5::DataSet>::type
 create_dataset(
     H5::CommonFG const& fg
-  , std::string const& name)
+  , std::string const& name
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
-    return detail::create_dataset<T, 0>(fg, name, NULL);
+    return detail::create_dataset<T, 0>(fg, name, NULL, filters, mode);
+}
+
+/** create dataset for a scalar of type T, stored as type S */
+template <typename T, typename S>
+inline typename boost::enable_if<boost::mpl::and_<has_ctype<T>, has_ctype<S> >, H5::DataSet>::type
+create_dataset(
+    H5::CommonFG const& fg
+  , std::string const& name
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
+{
+    return detail::create_dataset<S, 0>(fg, name, NULL, filters, mode);
 }
 
 template <typename T>
-inline typename boost::enable_if<boost::is_fundamental<T>, void>::type
+inline typename boost::enable_if<has_ctype<T>, void>::type
 write_dataset(H5::DataSet const& dataset, T const& data)
 {
     detail::write_dataset<T, 0>(dataset, &data);
 }
 
 template <typename T>
-inline typename boost::enable_if<boost::is_fundamental<T>, void>::type
+inline typename boost::enable_if<has_ctype<T>, void>::type
 read_dataset(H5::DataSet const& dataset, T& data)
 {
     return detail::read_dataset<T, 0>(dataset, &data);
@@ -147,21 +230,38 @@ read_dataset(H5::DataSet const& dataset, T& data)
 //
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_array<T>, boost::is_fundamental<typename T::value_type>
+        is_array<T>, has_ctype<typename T::value_type>
     >, H5::DataSet>::type
 create_dataset(
     H5::CommonFG const& fg
-  , std::string const& name)
+  , std::string const& name
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
     typedef typename T::value_type value_type;
     enum { rank = 1 };
     hsize_t shape[1] = { T::static_size };
-    return detail::create_dataset<value_type, rank>(fg, name, shape);
+    return detail::create_dataset<value_type, rank>(fg, name, shape, filters, mode);
+}
+
+/** create dataset for a fixed-size array of type T with elements stored as type S */
+template <typename T, typename S>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_array<T>, has_ctype<typename T::value_type>, has_ctype<S>
+    >, H5::DataSet>::type
+create_dataset(
+    H5::CommonFG const& fg
+  , std::string const& name
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
+{
+    hsize_t shape[1] = { T::static_size };
+    return detail::create_dataset<S, 1>(fg, name, shape, filters, mode);
 }
 
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_array<T>, boost::is_fundamental<typename T::value_type>
+        is_array<T>, has_ctype<typename T::value_type>
     >, void>::type
 write_dataset(H5::DataSet const& dataset, T const& data)
 {
@@ -176,7 +276,7 @@ write_dataset(H5::DataSet const& dataset, T const& data)
 
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_array<T>, boost::is_fundamental<typename T::value_type>
+        is_array<T>, has_ctype<typename T::value_type>
     >, void>::type
 read_dataset(H5::DataSet const& dataset, T& data)
 {
@@ -193,14 +293,32 @@ inline typename boost::enable_if<is_multi_array<T>, H5::DataSet>::type
 create_dataset(
     H5::CommonFG const& fg
   , std::string const& name
-  , typename T::size_type const* shape)
+  , typename T::size_type const* shape
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
     typedef typename T::element value_type;
     enum { rank = T::dimensionality };
     // convert T::size_type to hsize_t
     boost::array<hsize_t, rank> shape_;
     std::copy(shape, shape + rank, shape_.begin());
-    return detail::create_dataset<value_type, rank>(fg, name, &*shape_.begin());
+    return detail::create_dataset<value_type, rank>(fg, name, &*shape_.begin(), filters, mode);
+}
+
+/** create dataset for a multi_array of type T with elements stored as type S */
+template <typename T, typename S>
+inline typename boost::enable_if<boost::mpl::and_<is_multi_array<T>, has_ctype<S> >, H5::DataSet>::type
+create_dataset(
+    H5::CommonFG const& fg
+  , std::string const& name
+  , typename T::size_type const* shape
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
+{
+    enum { rank = T::dimensionality };
+    boost::array<hsize_t, rank> shape_;
+    std::copy(shape, shape + rank, shape_.begin());
+    return detail::create_dataset<S, rank>(fg, name, &*shape_.begin(), filters, mode);
 }
 
 template <typename T>
@@ -240,27 +358,178 @@ read_dataset(H5::DataSet const& dataset, T& data)
     return detail::read_dataset<value_type, rank>(dataset, data.origin());
 }
 
+/**
+ * write multi_array as a block of the dataset, starting at given offset;
+ * the shape of the block is the shape of the multi_array
+ */
+template <typename T>
+inline typename boost::enable_if<is_multi_array<T>, void>::type
+write_dataset(H5::DataSet const& dataset, T const& data, typename T::size_type const* offset)
+{
+    typedef typename T::element value_type;
+    enum { rank = T::dimensionality };
+    boost::array<hsize_t, rank> offset_, count;
+    std::copy(offset, offset + rank, offset_.begin());
+    std::copy(data.shape(), data.shape() + rank, count.begin());
+    detail::write_dataset<value_type, rank>(dataset, data.origin(), &*offset_.begin(), &*count.begin());
+}
+
+/**
+ * read block of given offset and shape from dataset into multi_array,
+ * resize/reshape result array if necessary
+ */
+template <typename T>
+inline typename boost::enable_if<is_multi_array<T>, void>::type
+read_dataset(
+    H5::DataSet const& dataset, T& data
+  , typename T::size_type const* offset, typename T::size_type const* count)
+{
+    typedef typename T::element value_type;
+    enum { rank = T::dimensionality };
+    boost::array<hsize_t, rank> offset_, count_;
+    std::copy(offset, offset + rank, offset_.begin());
+    std::copy(count, count + rank, count_.begin());
+    if (!std::equal(count_.begin(), count_.end(), data.shape())) {
+        data.resize(count_);
+    }
+    detail::read_dataset<value_type, rank>(dataset, data.origin(), &*offset_.begin(), &*count_.begin());
+}
+
+namespace detail {
+
+/**
+ * number of rows of a multi_array view along the outermost dimension that
+ * are copied at once for views with irregular strides
+ */
+template <typename T>
+inline std::size_t rows_per_block(T const& data)
+{
+    std::size_t row_bytes = std::max(row_elements(data), std::size_t(1)) * sizeof(typename T::element);
+    return std::max(std::size_t(CHUNK_MAX_SIZE) / row_bytes, std::size_t(1));
+}
+
+} // namespace detail
+
+/**
+ * write multi_array reference or view, which may have arbitrary strides
+ *
+ * Views with positive and nested strides, e.g., slices, are written
+ * without copying the data. Other views, e.g., transposed or reversed
+ * ones, are copied block by block along the outermost dimension to a
+ * dense buffer of at most detail::CHUNK_MAX_SIZE bytes, or a single row.
+ */
+template <typename T>
+inline typename boost::enable_if<is_multi_array_view<T>, void>::type
+write_dataset(H5::DataSet const& dataset, T const& data)
+{
+    typedef typename T::element value_type;
+    enum { rank = T::dimensionality };
+    if (!has_extent<T>(dataset, data.shape()))
+    {
+        throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace");
+    }
+    if (detail::has_regular_strides(data)) {
+        value_type const* base;
+        H5::DataSpace mem_dataspace = detail::memory_dataspace(data, base);
+        detail::write_data(dataset, base, mem_dataspace, H5::DataSpace(dataset.getSpace()));
+        return;
+    }
+
+    boost::array<hsize_t, rank> offset, count;
+    std::fill(offset.begin(), offset.end(), 0);
+    std::copy(data.shape(), data.shape() + rank, count.begin());
+    std::size_t rows = std::min(detail::rows_per_block(data), std::size_t(data.shape()[0]));
+    std::vector<value_type> buffer(rows * detail::row_elements(data));
+    for (std::size_t first = 0; first < data.shape()[0]; first += rows) {
+        count[0] = std::min(rows, data.shape()[0] - first);
+        offset[0] = first;
+        detail::gather_rows(data, first, count[0], &*buffer.begin());
+        detail::write_dataset<value_type, rank>(dataset, &*buffer.begin(), &*offset.begin(), &*count.begin());
+    }
+}
+
+/**
+ * read into mutable multi_array reference or view, which may have
+ * arbitrary strides; the shape of the view must match the dataset
+ *
+ * The view is passed by value, so that temporary views, e.g., array[indices[…]],
+ * may be given. Views with irregular strides are read block by block to a
+ * dense buffer and copied, see write_dataset().
+ */
+template <typename T>
+inline typename boost::enable_if<is_mutable_multi_array_view<T>, void>::type
+read_dataset(H5::DataSet const& dataset, T data)
+{
+    typedef typename T::element value_type;
+    enum { rank = T::dimensionality };
+    if (!has_extent<T>(dataset, data.shape()))
+    {
+        throw std::runtime_error("HDF5 reader: dataset has incompatible dataspace");
+    }
+    if (!detail::has_regular_strides(data)) {
+        boost::array<hsize_t, rank> offset, count;
+        std::fill(offset.begin(), offset.end(), 0);
+        std::copy(data.shape(), data.shape() + rank, count.begin());
+        std::size_t rows = std::min(detail::rows_per_block(data), std::size_t(data.shape()[0]));
+        std::vector<value_type> buffer(rows * detail::row_elements(data));
+        for (std::size_t first = 0; first < data.shape()[0]; first += rows) {
+            count[0] = std::min(rows, data.shape()[0] - first);
+            offset[0] = first;
+            detail::read_dataset<value_type, rank>(dataset, &*buffer.begin(), &*offset.begin(), &*count.begin());
+            detail::scatter_rows(&*buffer.begin(), data, first, count[0]);
+        }
+        return;
+    }
+    value_type const* base;
+    H5::DataSpace mem_dataspace = detail::memory_dataspace(data, base);
+    try {
+        H5XX_NO_AUTO_PRINT(H5::Exception);
+        dataset.read(const_cast<value_type*>(base), ctype<value_type>::hid(), mem_dataspace, dataset.getSpace());
+    }
+    catch (H5::Exception const&) {
+        throw std::runtime_error("HDF5 reader: failed to read multidimensional array data");
+    }
+}
+
 //
 // vector containers holding scalars
 //
 // pass length of vector as third parameter
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_vector<T>, boost::is_fundamental<typename T::value_type>
+        is_vector<T>, has_ctype<typename T::value_type>
     >, H5::DataSet>::type
 create_dataset(
     H5::CommonFG const& fg
   , std::string const& name
-  , typename T::size_type size)
+  , typename T::size_type size
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
     typedef typename T::value_type value_type;
     hsize_t shape[1] = { size };
-    return detail::create_dataset<value_type, 1>(fg, name, shape);
+    return detail::create_dataset<value_type, 1>(fg, name, shape, filters, mode);
+}
+
+/** create dataset for a vector of type T with elements stored as type S */
+template <typename T, typename S>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, has_ctype<typename T::value_type>, has_ctype<S>
+    >, H5::DataSet>::type
+create_dataset(
+    H5::CommonFG const& fg
+  , std::string const& name
+  , typename T::size_type size
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
+{
+    hsize_t shape[1] = { size };
+    return detail::create_dataset<S, 1>(fg, name, shape, filters, mode);
 }
 
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_vector<T>, boost::is_fundamental<typename T::value_type>
+        is_vector<T>, has_ctype<typename T::value_type>
     >, void>::type
 write_dataset(H5::DataSet const& dataset, T const& data)
 {
@@ -281,7 +550,7 @@ write_dataset(H5::DataSet const& dataset, T const& data)
 /** read vector container with scalar data, resize/reshape result array if necessary */
 template <typename T>
 inline typename boost::enable_if<boost::mpl::and_<
-        is_vector<T>, boost::is_fundamental<typename T::value_type>
+        is_vector<T>, has_ctype<typename T::value_type>
     >, void>::type
 read_dataset(H5::DataSet const& dataset, T& data)
 {
@@ -299,6 +568,30 @@ read_dataset(H5::DataSet const& dataset, T& data)
     detail::read_dataset<value_type, 1>(dataset, &*data.begin());
 }
 
+/** write vector as the elements offset, …, offset + data.size() - 1 of the dataset */
+template <typename T>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, has_ctype<typename T::value_type>
+    >, void>::type
+write_dataset(H5::DataSet const& dataset, T const& data, hsize_t offset)
+{
+    typedef typename T::value_type value_type;
+    hsize_t count = data.size();
+    detail::write_dataset<value_type, 1>(dataset, data.empty() ? NULL : &*data.begin(), &offset, &count);
+}
+
+/** read elements offset, …, offset + count - 1 of the dataset, resize result vector */
+template <typename T>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, has_ctype<typename T::value_type>
+    >, void>::type
+read_dataset(H5::DataSet const& dataset, T& data, hsize_t offset, hsize_t count)
+{
+    typedef typename T::value_type value_type;
+    data.resize(count);
+    detail::read_dataset<value_type, 1>(dataset, data.empty() ? NULL : &*data.begin(), &offset, &count);
+}
+
 //
 // vector containers holding fixed-size arrays
 //
@@ -310,12 +603,30 @@ inline typename boost::enable_if<boost::mpl::and_<
 create_dataset(
     H5::CommonFG const& fg
   , std::string const& name
-  , typename T::size_type size)
+  , typename T::size_type size
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
 {
     typedef typename T::value_type array_type;
     typedef typename array_type::value_type value_type;
     hsize_t shape[2] = { size, array_type::static_size };
-    return detail::create_dataset<value_type, 2>(fg, name, shape);
+    return detail::create_dataset<value_type, 2>(fg, name, shape, filters, mode);
+}
+
+/** create dataset for a vector of arrays of type T with elements stored as type S */
+template <typename T, typename S>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, is_array<typename T::value_type>, has_ctype<S>
+    >, H5::DataSet>::type
+create_dataset(
+    H5::CommonFG const& fg
+  , std::string const& name
+  , typename T::size_type size
+  , filter_pipeline const& filters=filter_pipeline().deflate()
+  , create_mode mode=replace_existing)
+{
+    hsize_t shape[2] = { size, T::value_type::static_size };
+    return detail::create_dataset<S, 2>(fg, name, shape, filters, mode);
 }
 
 template <typename T>
@@ -363,6 +674,35 @@ read_dataset(H5::DataSet const& dataset, T& data)
     detail::read_dataset<value_type, 2>(dataset, &*data.begin()->begin());
 }
 
+/** write vector of arrays as the records offset, …, offset + data.size() - 1 of the dataset */
+template <typename T>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, is_array<typename T::value_type>
+    >, void>::type
+write_dataset(H5::DataSet const& dataset, T const& data, hsize_t offset)
+{
+    typedef typename T::value_type array_type;
+    typedef typename array_type::value_type value_type;
+    hsize_t offset_[2] = { offset, 0 };
+    hsize_t count[2] = { data.size(), array_type::static_size };
+    detail::write_dataset<value_type, 2>(dataset, data.empty() ? NULL : &*data.begin()->begin(), offset_, count);
+}
+
+/** read records offset, …, offset + count - 1 of the dataset, resize result vector */
+template <typename T>
+inline typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, is_array<typename T::value_type>
+    >, void>::type
+read_dataset(H5::DataSet const& dataset, T& data, hsize_t offset, hsize_t count)
+{
+    typedef typename T::value_type array_type;
+    typedef typename array_type::value_type value_type;
+    hsize_t offset_[2] = { offset, 0 };
+    hsize_t count_[2] = { count, array_type::static_size };
+    data.resize(count);
+    detail::read_dataset<value_type, 2>(dataset, data.empty() ? NULL : &*data.begin()->begin(), offset_, count_);
+}
+
 /**
  * Helper function to create a dataset on the fly and write to it.
  */
@@ -393,6 +733,90 @@ inline void read_dataset(H5::CommonFG const& fg, std::string const& name, T& dat
     } H5E_END_TRY
 }
 
+/**
+ * Typed handle of a fixed-size dataset holding data of type T
+ *
+ * The handle validates rank and shape of the dataset upon construction
+ * and keeps the native data type, the dataspace and the storage type of
+ * the dataset. Repeated reads and writes thus neither query the dataset's
+ * metadata nor create new HDF5 objects. The data type T is any type
+ * supported by write_dataset() except multi_array views.
+ *
+ * Data of double or single precision are converted to a reduced-precision
+ * storage type by the kernels of h5xx, see create_dataset<T, S>(), into a
+ * buffer that is kept between writes.
+ */
+template <typename T>
+class fixed_dataset
+{
+private:
+    typedef detail::record_traits<T> traits_type;
+
+public:
+    typedef T data_type;
+    typedef typename traits_type::value_type value_type;
+    enum { rank = traits_type::rank };
+
+    explicit fixed_dataset(H5::DataSet const& dataset)
+      : dataset_(dataset)
+      , space_(dataset.getSpace())
+    {
+        if (!has_rank<rank>(space_)) {
+            throw std::runtime_error("HDF5 dataset: dataset has incompatible dataspace");
+        }
+        space_.getSimpleExtentDims(dim_.data());
+        if (!traits_type::is_valid_shape(dim_.data())) {
+            throw std::runtime_error("HDF5 dataset: dataset has incompatible dataspace");
+        }
+        type_ = H5::DataType(ctype<value_type>::hid());
+        storage_ = detail::storage_of(dataset_);
+    }
+
+    /** write data, whose shape must match the dataset */
+    void write(T const& data)
+    {
+        if (!traits_type::has_shape(data, dim_.data())) {
+            throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace");
+        }
+        detail::write_data(dataset_, traits_type::data(data), space_, space_, storage_, buffer_);
+    }
+
+    /** read data, resize/reshape result if necessary */
+    void read(T& data) const
+    {
+        traits_type::resize(data, dim_.data());
+        herr_t err;
+        H5E_BEGIN_TRY {
+            err = H5Dread(dataset_.getId(), type_.getId(), space_.getId(), space_.getId(), H5P_DEFAULT, traits_type::data(data));
+        } H5E_END_TRY
+        if (err < 0) {
+            throw std::runtime_error("HDF5 reader: failed to read multidimensional array data");
+        }
+    }
+
+    /** shape of the dataset */
+    hsize_t const* shape() const
+    {
+        return dim_.data();
+    }
+
+    H5::DataSet const& dataset() const
+    {
+        return dataset_;
+    }
+
+private:
+    H5::DataSet dataset_;
+    H5::DataType type_;
+    /** reduced-precision storage type, converted to upon writing */
+    detail::storage_type storage_;
+    /** converted data */
+    std::vector<char> buffer_;
+    H5::DataSpace space_;
+    /** extents of dataspace */
+    boost::array<hsize_t, rank> dim_;
+};
+
 } // namespace h5xx
 
 #endif /* ! H5XX_DATASET_HPP */
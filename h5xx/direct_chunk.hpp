@@ -0,0 +1,658 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H5XX_DIRECT_CHUNK_HPP
+#define H5XX_DIRECT_CHUNK_HPP
+
+#include <h5xx/chunked_dataset.hpp>
+#include <h5xx/error.hpp>
+#include <h5xx/thread_pool.hpp>
+#include <h5xx/utility.hpp>
+
+#include <boost/array.hpp>
+#include <boost/mpl/and.hpp>
+#include <boost/mpl/or.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include <zlib.h>
+
+/**
+ * direct chunk I/O has been added to the C API in HDF5 1.10.3, and the
+ * storage size of a chunk can be queried since HDF5 1.10.5
+ */
+#if !H5_VERSION_GE(1,10,5)
+# error "h5xx/direct_chunk.hpp requires HDF5 1.10.5 or later"
+#endif
+
+namespace h5xx {
+namespace detail {
+
+/**
+ * Layout of a chunked dataset suitable for direct chunk I/O
+ *
+ * The dataset must be chunked with chunks spanning whole records, i.e., the
+ * chunks may subdivide the outermost dimension only, and its filter
+ * pipeline may consist of the shuffle and the deflate filters only, in this
+ * order.
+ */
+struct chunk_layout
+{
+    /** extents of dataspace, the record shape is given by dim[1:] */
+    std::vector<hsize_t> dim;
+    std::vector<hsize_t> max_dim;
+    /** number of records per chunk */
+    hsize_t chunk_records;
+    /** number of elements per record */
+    hsize_t record_size;
+    /** deflate level, or -1 if not applied */
+    int deflate;
+    /** true if the shuffle filter is applied */
+    bool shuffle;
+    /** bits of the filter mask of a chunk indicating a skipped filter */
+    uint32_t deflate_mask;
+    uint32_t shuffle_mask;
+
+    explicit chunk_layout(H5::DataSet const& dataset)
+      : deflate(-1)
+      , shuffle(false)
+      , deflate_mask(0)
+      , shuffle_mask(0)
+    {
+        H5::DataSpace dataspace(dataset.getSpace());
+        int const rank = dataspace.isSimple() ? dataspace.getSimpleExtentNdims() : 0;
+        if (rank < 1) {
+            throw error("direct chunk I/O: dataset has incompatible dataspace");
+        }
+        dim.resize(rank);
+        max_dim.resize(rank);
+        dataspace.getSimpleExtentDims(&*dim.begin(), &*max_dim.begin());
+
+        H5::DSetCreatPropList cparms(dataset.getCreatePlist());
+        if (cparms.getLayout() != H5D_CHUNKED) {
+            throw error("direct chunk I/O: dataset is not chunked");
+        }
+        std::vector<hsize_t> chunk_dim(rank);
+        cparms.getChunk(rank, &*chunk_dim.begin());
+        if (!std::equal(chunk_dim.begin() + 1, chunk_dim.end(), dim.begin() + 1)) {
+            throw error("direct chunk I/O: chunks must span whole records");
+        }
+        chunk_records = chunk_dim[0];
+        record_size = std::accumulate(dim.begin() + 1, dim.end(), hsize_t(1), std::multiplies<hsize_t>());
+
+        int nfilters = cparms.getNfilters();
+        for (int i = 0; i < nfilters; ++i) {
+            unsigned int flags, config;
+            size_t nelmts = 1;
+            unsigned int cd_values[1] = { 0 };
+            H5Z_filter_t filter = H5Pget_filter2(
+                cparms.getId(), i, &flags, &nelmts, cd_values, 0, NULL, &config
+            );
+            if (filter == H5Z_FILTER_DEFLATE && deflate < 0) {
+                deflate = cd_values[0];
+                deflate_mask = 1U << i;
+            }
+            else if (filter == H5Z_FILTER_SHUFFLE && !shuffle && deflate < 0) {
+                shuffle = true;
+                shuffle_mask = 1U << i;
+            }
+            else {
+                throw error("direct chunk I/O: unsupported filter pipeline");
+            }
+        }
+    }
+};
+
+/**
+ * byte shuffling as done by the shuffle filter of HDF5: the i-th bytes of
+ * all elements are stored contiguously, for i = 0, …, size - 1
+ */
+inline void shuffle_bytes(std::vector<char>& data, std::size_t size)
+{
+    std::size_t n = data.size() / size;
+    if (size < 2 || n < 2) {
+        return;
+    }
+    std::vector<char> out(data.size());
+    for (std::size_t j = 0; j < size; ++j) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[j * n + i] = data[i * size + j];
+        }
+    }
+    // trailing bytes, which do not form a complete element, are not shuffled
+    std::copy(data.begin() + n * size, data.end(), out.begin() + n * size);
+    data.swap(out);
+}
+
+/** inverse of shuffle_bytes() */
+inline void unshuffle_bytes(std::vector<char>& data, std::size_t size)
+{
+    std::size_t n = data.size() / size;
+    if (size < 2 || n < 2) {
+        return;
+    }
+    std::vector<char> out(data.size());
+    for (std::size_t j = 0; j < size; ++j) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i * size + j] = data[j * n + i];
+        }
+    }
+    std::copy(data.begin() + n * size, data.end(), out.begin() + n * size);
+    data.swap(out);
+}
+
+/**
+ * chunk to be compressed in the thread pool
+ */
+struct deflate_chunk_task
+  : pool_task
+{
+    deflate_chunk_task(hsize_t chunk, hsize_t length, std::vector<char> const& raw, int level, std::size_t shuffle)
+      : chunk(chunk)
+      , length(length)
+      , data(raw)
+      , level(level)
+      , shuffle(shuffle) {}
+
+    void run()
+    {
+        if (shuffle > 0) {
+            shuffle_bytes(data, shuffle);
+        }
+        if (level < 0) {
+            return;
+        }
+        std::vector<char> compressed(compressBound(data.size()));
+        uLongf size = compressed.size();
+        int err = compress2(
+            reinterpret_cast<Bytef*>(&*compressed.begin()), &size
+          , reinterpret_cast<Bytef const*>(&*data.begin()), data.size(), level
+        );
+        if (err != Z_OK) {
+            throw error("failed to compress chunk");
+        }
+        compressed.resize(size);
+        data.swap(compressed);
+    }
+
+    /** index of chunk along the outermost dimension */
+    hsize_t const chunk;
+    /** number of records in the dataset including this chunk */
+    hsize_t const length;
+    /** raw data of the chunk, compressed data after run() */
+    std::vector<char> data;
+    int const level;
+    /** element size for byte shuffling, or 0 */
+    std::size_t const shuffle;
+};
+
+/**
+ * chunk to be decompressed in the thread pool, the selected records are
+ * copied to their destination afterwards
+ */
+struct inflate_chunk_task
+  : pool_task
+{
+    inflate_chunk_task(std::size_t chunk_bytes, std::size_t record_bytes)
+      : chunk_bytes(chunk_bytes)
+      , record_bytes(record_bytes)
+      , compressed(false)
+      , shuffle(0) {}
+
+    void run()
+    {
+        if (compressed) {
+            std::vector<char> raw(chunk_bytes);
+            uLongf size = raw.size();
+            int err = uncompress(
+                reinterpret_cast<Bytef*>(&*raw.begin()), &size
+              , reinterpret_cast<Bytef const*>(&*data.begin()), data.size()
+            );
+            if (err != Z_OK || size != raw.size()) {
+                throw error("failed to decompress chunk");
+            }
+            data.swap(raw);
+        }
+        if (data.size() < chunk_bytes) {
+            throw error("chunk has unexpected size");
+        }
+        if (shuffle > 0) {
+            unshuffle_bytes(data, shuffle);
+        }
+        for (hsize_t i = 0; i < records; ++i) {
+            std::memcpy(dest + i * record_bytes, &*data.begin() + (first + i * stride) * record_bytes, record_bytes);
+        }
+    }
+
+    std::size_t const chunk_bytes;
+    std::size_t const record_bytes;
+    /** chunk as stored in the file */
+    std::vector<char> data;
+    /** true if the deflate filter has been applied to the chunk */
+    bool compressed;
+    /** element size if the shuffle filter has been applied to the chunk, or 0 */
+    std::size_t shuffle;
+    /** first selected record within the chunk */
+    hsize_t first;
+    /** number of selected records */
+    hsize_t records;
+    hsize_t stride;
+    /** destination of first selected record */
+    char* dest;
+};
+
+} // namespace detail
+
+/**
+ * Appender for chunked datasets with parallel chunk compression
+ *
+ * Records are collected chunk by chunk. Complete chunks are compressed by a
+ * pool of worker threads using zlib with the deflate level of the dataset,
+ * after byte shuffling if the dataset applies the shuffle filter,
+ * and the compressed chunks are stored by the calling thread with direct
+ * chunk writes, which bypass the filter pipeline of the HDF5 library. The
+ * resulting files are readable by any HDF5 library.
+ *
+ * The dataset must be chunked with chunks spanning whole records and its
+ * filter pipeline may consist of the shuffle and deflate filters only, as
+ * created by create_chunked_dataset() by default or with a pipeline of
+ * filter_pipeline().shuffle().deflate(). The type in the file must be the native type of
+ * the records, since no type conversion is applied.
+ *
+ * flush() writes the pending chunks, including the incomplete last chunk,
+ * which is padded with zeros and rewritten once further records arrive.
+ * The destructor calls flush(), but cannot report errors.
+ *
+ * This header is not included by h5xx/h5xx.hpp, requires HDF5 1.10.5 or
+ * later and linking to the Boost.Thread and zlib libraries.
+ */
+template <typename T>
+class direct_chunk_writer
+  : boost::noncopyable
+{
+private:
+    typedef detail::record_traits<T> traits_type;
+    typedef boost::shared_ptr<detail::deflate_chunk_task> task_ptr;
+
+public:
+    typedef T record_type;
+    typedef typename traits_type::value_type value_type;
+    enum { rank = traits_type::rank };
+
+    /**
+     * append to chunked dataset using the given number of compression
+     * threads, or one thread per hardware thread for threads = 0
+     */
+    explicit direct_chunk_writer(H5::DataSet const& dataset, unsigned int threads=0)
+      : dataset_(dataset)
+      , pool_(threads)
+      , fill_(0)
+    {
+        if (!has_rank<rank+1>(dataset_) || !has_type<value_type>(dataset_)) {
+            throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace or type");
+        }
+        detail::chunk_layout layout(dataset_);
+        std::copy(layout.dim.begin(), layout.dim.end(), dim_.begin());
+        length_ = dim_[0];
+        max_length_ = layout.max_dim[0];
+        chunk_records_ = layout.chunk_records;
+        record_size_ = layout.record_size;
+        level_ = layout.deflate;
+        shuffle_ = layout.shuffle ? sizeof(value_type) : 0;
+        buffer_.resize(chunk_records_ * record_size_ * sizeof(value_type));
+
+        // continue incomplete last chunk
+        fill_ = length_ % chunk_records_;
+        if (fill_ > 0) {
+            detail::read_chunked_dataset(
+                dataset_, reinterpret_cast<value_type*>(&*buffer_.begin()), length_ - fill_, fill_
+            );
+        }
+    }
+
+    ~direct_chunk_writer()
+    {
+        try {
+            flush();
+        }
+        catch (...) {}
+    }
+
+    /**
+     * append record, compress chunk in the background once it is complete
+     */
+    void push_back(T const& record)
+    {
+        if (!traits_type::has_shape(record, &*dim_.begin() + 1)) {
+            throw std::runtime_error("HDF5 writer: dataset has incompatible dataspace");
+        }
+        if (length_ >= max_length_) {
+            throw std::runtime_error("HDF5 writer: fixed-size dataset cannot be extended");
+        }
+        std::size_t size = record_size_ * sizeof(value_type);
+        std::memcpy(&*buffer_.begin() + fill_ * size, traits_type::data(record), size);
+        ++length_;
+        if (++fill_ == chunk_records_) {
+            submit();
+            fill_ = 0;
+            std::fill(buffer_.begin(), buffer_.end(), 0);
+        }
+    }
+
+    /**
+     * write all pending chunks including the incomplete last chunk
+     */
+    void flush()
+    {
+        if (fill_ > 0) {
+            submit();
+        }
+        drain(0);
+    }
+
+    /** number of records in the dataset, including pending records */
+    hsize_t length() const
+    {
+        return length_;
+    }
+
+    /** number of compression threads */
+    unsigned int threads() const
+    {
+        return pool_.size();
+    }
+
+    H5::DataSet const& dataset() const
+    {
+        return dataset_;
+    }
+
+private:
+    /** compress current chunk in the background */
+    void submit()
+    {
+        hsize_t chunk = (length_ - 1) / chunk_records_;
+        task_ptr task(new detail::deflate_chunk_task(chunk, length_, buffer_, level_, shuffle_));
+        pending_.push_back(task);
+        pool_.submit(task);
+        // limit memory held by compressed chunks awaiting output
+        drain(2 * pool_.size());
+    }
+
+    /** write compressed chunks in order until at most 'count' are pending */
+    void drain(std::size_t count)
+    {
+        while (pending_.size() > count) {
+            task_ptr task = pending_.front();
+            pending_.pop_front();
+            pool_.wait(*task);
+            write(*task);
+        }
+    }
+
+    /** store compressed chunk, extend dataset if necessary */
+    void write(detail::deflate_chunk_task const& task)
+    {
+        if (task.length > dim_[0]) {
+            boost::array<hsize_t, rank+1> dim = dim_;
+            dim[0] = task.length;
+            if (H5Dset_extent(dataset_.getId(), &*dim.begin()) < 0) {
+                throw error("failed to extend dataset");
+            }
+            dim_[0] = task.length;
+        }
+        boost::array<hsize_t, rank+1> offset;
+        std::fill(offset.begin(), offset.end(), 0);
+        offset[0] = task.chunk * chunk_records_;
+        herr_t err = H5Dwrite_chunk(
+            dataset_.getId(), H5P_DEFAULT, 0, &*offset.begin(), task.data.size(), &*task.data.begin()
+        );
+        if (err < 0) {
+            throw error("failed to write chunk");
+        }
+    }
+
+    H5::DataSet dataset_;
+    detail::thread_pool pool_;
+    /** extents of dataspace, the record shape is given by dim_[1:] */
+    boost::array<hsize_t, rank+1> dim_;
+    /** number of records per chunk */
+    hsize_t chunk_records_;
+    /** number of elements per record */
+    hsize_t record_size_;
+    /** deflate level, or -1 for no compression */
+    int level_;
+    /** element size for byte shuffling, or 0 */
+    std::size_t shuffle_;
+    /** number of records including pending records */
+    hsize_t length_;
+    /** maximum extent of dataset along the outermost dimension */
+    hsize_t max_length_;
+    /** raw data of current chunk */
+    std::vector<char> buffer_;
+    /** number of records in current chunk */
+    hsize_t fill_;
+    /** chunks submitted for compression, in order of submission */
+    std::deque<task_ptr> pending_;
+};
+
+/**
+ * Reader for chunked datasets with parallel chunk decompression
+ *
+ * read() is equivalent to the range reads of read_chunked_dataset(), but
+ * fetches the chunks as stored in the file by direct chunk reads and
+ * decompresses them on a pool of worker threads, which keeps the file I/O
+ * in the calling thread busy meanwhile. Chunks that have not been written
+ * yet are read through the HDF5 library.
+ *
+ * The requirements on the dataset are the same as for direct_chunk_writer.
+ * A reader may be used for any number of datasets, the worker threads are
+ * kept until the reader is destroyed.
+ *
+ * This header is not included by h5xx/h5xx.hpp, requires HDF5 1.10.5 or
+ * later and linking to the Boost.Thread and zlib libraries.
+ */
+class direct_chunk_reader
+  : boost::noncopyable
+{
+private:
+    typedef boost::shared_ptr<detail::inflate_chunk_task> task_ptr;
+
+public:
+    /**
+     * start given number of decompression threads, or one thread per
+     * hardware thread for threads = 0
+     */
+    explicit direct_chunk_reader(unsigned int threads=0)
+      : pool_(threads) {}
+
+    /**
+     * read the records first, first + stride, …, first + (count - 1) * stride
+     * of any shape into contiguous array of sufficient size
+     */
+    template <typename T>
+    typename boost::enable_if<has_ctype<T>, void>::type
+    read(H5::DataSet const& dataset, T* data, hsize_t first, hsize_t count, hsize_t stride=1)
+    {
+        if (!has_type<T>(dataset)) {
+            throw std::runtime_error("HDF5 reader: dataset has incompatible type");
+        }
+        read_chunks(dataset, data, first, count, stride);
+    }
+
+    /**
+     * read range of scalar or fixed-size array records into vector
+     * container, resize result vector
+     */
+    template <typename T>
+    typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>
+      , boost::mpl::or_<has_ctype<typename T::value_type>, is_array<typename T::value_type> >
+    >, void>::type
+    read(H5::DataSet const& dataset, T& data, hsize_t first, hsize_t count, hsize_t stride=1)
+    {
+        typedef detail::record_traits<typename T::value_type> traits_type;
+        H5::DataSpace dataspace(dataset.getSpace());
+        if (!has_rank<traits_type::rank+1>(dataspace)) {
+            throw std::runtime_error("HDF5 reader: dataset has incompatible dataspace");
+        }
+        boost::array<hsize_t, traits_type::rank+1> dim;
+        dataspace.getSimpleExtentDims(&*dim.begin());
+        if (!traits_type::is_valid_shape(&*dim.begin() + 1)) {
+            throw std::runtime_error("HDF5 reader: dataset has incompatible dataspace");
+        }
+        data.resize(count);
+        // raw data are laid out contiguously
+        read(dataset, count > 0 ? traits_type::data(*data.begin()) : NULL, first, count, stride);
+    }
+
+    /**
+     * read range of records into multi_array of rank equal to the dataset,
+     * resize/reshape result array if necessary
+     */
+    template <typename T>
+    typename boost::enable_if<is_multi_array<T>, void>::type
+    read(H5::DataSet const& dataset, T& data, hsize_t first, hsize_t count, hsize_t stride=1)
+    {
+        enum { rank = T::dimensionality };
+
+        H5::DataSpace dataspace(dataset.getSpace());
+        if (!has_rank<rank>(dataspace)) {
+            throw std::runtime_error("HDF5 reader: dataset has incompatible dataspace");
+        }
+        boost::array<hsize_t, rank> dim;
+        dataspace.getSimpleExtentDims(&*dim.begin());
+        dim[0] = count;
+
+        if (!std::equal(dim.begin(), dim.end(), data.shape())) {
+            boost::array<size_t, rank> shape;
+            std::copy(dim.begin(), dim.end(), shape.begin());
+            data.resize(shape);
+        }
+        read(dataset, data.origin(), first, count, stride);
+    }
+
+    /** number of decompression threads */
+    unsigned int threads() const
+    {
+        return pool_.size();
+    }
+
+private:
+    /** read selected records chunk by chunk, element type has been checked */
+    template <typename T>
+    void read_chunks(H5::DataSet const& dataset, T* data, hsize_t first, hsize_t records, hsize_t stride)
+    {
+        detail::chunk_layout layout(dataset);
+        if (stride == 0) {
+            throw std::runtime_error("HDF5 reader: stride must be positive");
+        }
+        hsize_t const length = layout.dim[0];
+        if (records == 0) {
+            if (first > length) {
+                throw std::runtime_error("HDF5 reader: index out of bounds");
+            }
+            return;
+        }
+        if (first >= length || (records - 1) > (length - 1 - first) / stride) {
+            throw std::runtime_error("HDF5 reader: index out of bounds");
+        }
+
+        std::size_t const record_bytes = layout.record_size * sizeof(T);
+        std::size_t const chunk_bytes = layout.chunk_records * record_bytes;
+        std::vector<hsize_t> offset(layout.dim.size(), 0);
+        std::deque<task_ptr> pending;
+
+        try {
+            for (hsize_t i = 0; i < records; ) {
+                // select all records within the chunk containing record #i
+                hsize_t index = first + i * stride;
+                hsize_t chunk_first = index - index % layout.chunk_records;
+                hsize_t n = std::min(records - i, (chunk_first + layout.chunk_records - 1 - index) / stride + 1);
+                offset[0] = chunk_first;
+
+                hsize_t bytes = 0;
+                herr_t err;
+                H5E_BEGIN_TRY {
+                    err = H5Dget_chunk_storage_size(dataset.getId(), &*offset.begin(), &bytes);
+                } H5E_END_TRY
+                if (err < 0 || bytes == 0) {
+                    // chunk is not allocated, let the library apply the fill value
+                    detail::read_chunked_dataset(dataset, data + i * layout.record_size, index, n, stride);
+                }
+                else {
+                    uint32_t filters = 0;
+                    task_ptr task(new detail::inflate_chunk_task(chunk_bytes, record_bytes));
+                    task->data.resize(bytes);
+                    if (H5Dread_chunk(dataset.getId(), H5P_DEFAULT, &*offset.begin(), &filters, &*task->data.begin()) < 0) {
+                        throw error("failed to read chunk");
+                    }
+                    // the filter mask indicates skipped filters
+                    task->compressed = layout.deflate >= 0 && !(filters & layout.deflate_mask);
+                    task->shuffle = layout.shuffle && !(filters & layout.shuffle_mask) ? sizeof(T) : 0;
+                    task->first = index - chunk_first;
+                    task->records = n;
+                    task->stride = stride;
+                    task->dest = reinterpret_cast<char*>(data + i * layout.record_size);
+                    pending.push_back(task);
+                    pool_.submit(task);
+                    // limit memory held by chunks awaiting decompression
+                    drain(pending, 2 * pool_.size());
+                }
+                i += n;
+            }
+            drain(pending, 0);
+        }
+        catch (...) {
+            // the tasks write to the destination array, which may be released after return
+            while (!pending.empty()) {
+                try {
+                    pool_.wait(*pending.front());
+                }
+                catch (...) {}
+                pending.pop_front();
+            }
+            throw;
+        }
+    }
+
+    /** wait for chunks in order until at most 'count' are pending */
+    void drain(std::deque<task_ptr>& pending, std::size_t count)
+    {
+        while (pending.size() > count) {
+            task_ptr task = pending.front();
+            pool_.wait(*task);
+            pending.pop_front();
+        }
+    }
+
+    detail::thread_pool pool_;
+};
+
+} // namespace h5xx
+
+#endif /* ! H5XX_DIRECT_CHUNK_HPP */
@@ -0,0 +1,459 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H5XX_FILE_HPP
+#define H5XX_FILE_HPP
+
+#include <h5xx/error.hpp>
+#include <h5xx/hdf5_compat.hpp>
+
+#include <algorithm>
+#include <string>
+
+#ifndef _WIN32
+# include <sys/stat.h>
+#endif
+
+namespace h5xx {
+namespace detail {
+
+/** oldest file format with compact and indexed storage of links, HDF5 1.8 */
+inline H5F_libver_t libver_v18()
+{
+#if H5_VERSION_GE(1,10,2)
+    return H5F_LIBVER_V18;
+#else
+    return H5F_LIBVER_LATEST;
+#endif
+}
+
+/**
+ * preferred I/O block size of the file system holding file 'name', which
+ * reports the stripe size on parallel file systems
+ */
+inline hsize_t block_size(std::string const& name)
+{
+#ifndef _WIN32
+    std::string::size_type pos = name.rfind('/');
+    std::string dir = (pos == std::string::npos) ? "." : name.substr(0, std::max(pos, std::string::size_type(1)));
+    struct stat st;
+    if (stat(dir.c_str(), &st) == 0 && st.st_blksize > 0) {
+        return st.st_blksize;
+    }
+#endif
+    return 4096;
+}
+
+} // namespace detail
+
+/**
+ * File access properties of an HDF5 file
+ *
+ * A default-constructed object keeps the defaults of the HDF5 library.
+ * Properties are set by chaining, e.g.,
+ *
+ *     file_access().alignment(65536).chunk_cache(16 << 20, 2053)
+ *
+ * or taken from one of the presets, which may be modified further. The
+ * properties are applied by open_file() and create_file().
+ */
+class file_access
+{
+public:
+    /**
+     * appending records to chunked datasets, e.g., time series
+     *
+     * Uses the latest file format with its faster chunk index for datasets
+     * of unlimited size, which may not be read by HDF5 versions before 1.10.
+     * Aligns chunks to the file system blocks and evicts chunks from the
+     * cache once written completely.
+     */
+    static file_access streaming_append()
+    {
+        return file_access()
+            .libver_bounds(H5F_LIBVER_LATEST)
+            .alignment(65536)
+            .meta_block(65536)
+            .chunk_cache(4 << 20, 521, 1);
+    }
+
+    /**
+     * reading datasets in random order for analysis
+     *
+     * Holds many chunks, much metadata and, for files of paged file space,
+     * many pages in the caches and reads contiguous datasets in large blocks.
+     */
+    static file_access random_read()
+    {
+        return file_access()
+            .metadata_cache(16 << 20, 64 << 20)
+            .sieve_buffer(4 << 20)
+            .page_buffer(16 << 20)
+            .chunk_cache(64 << 20, 10007, 0.75);
+    }
+
+    /**
+     * writing large datasets at once, e.g., checkpoints
+     *
+     * Aligns large datasets to the file system blocks and aggregates
+     * metadata and raw data in large blocks.
+     */
+    static file_access checkpoint()
+    {
+        return file_access()
+            .libver_bounds(detail::libver_v18())
+            .alignment(1 << 20)
+            .meta_block(1 << 20)
+            .small_data_block(1 << 20)
+            .sieve_buffer(4 << 20)
+            .chunk_cache(16 << 20, 2053, 1);
+    }
+
+    /**
+     * many small groups, attributes and datasets
+     *
+     * Stores links compactly, or indexed for large groups, holds much
+     * metadata and, for files of paged file space, pages in the caches and
+     * aggregates metadata and small datasets in blocks. Only large datasets
+     * are aligned to the file system blocks.
+     */
+    static file_access small_metadata()
+    {
+        return file_access()
+            .libver_bounds(detail::libver_v18())
+            .alignment(1 << 20)
+            .metadata_cache(8 << 20, 32 << 20)
+            .meta_block(65536)
+            .small_data_block(65536)
+            .page_buffer(4 << 20);
+    }
+
+    /** defaults of the HDF5 library */
+    file_access()
+      : libver_(false)
+      , low_(H5F_LIBVER_EARLIEST)
+      , high_(H5F_LIBVER_LATEST)
+      , align_(false)
+      , align_threshold_(1)
+      , align_bytes_(1)
+      , mdc_initial_(0)
+      , mdc_max_(0)
+      , sieve_(0)
+      , meta_block_(0)
+      , small_data_block_(0)
+      , page_buffer_(0)
+      , page_min_meta_(0)
+      , page_min_raw_(0)
+      , cache_nbytes_(0)
+      , cache_nslots_(0)
+      , cache_w0_(0.75) {}
+
+    /** range of file format versions used for new objects */
+    file_access& libver_bounds(H5F_libver_t low, H5F_libver_t high=H5F_LIBVER_LATEST)
+    {
+        libver_ = true;
+        low_ = low;
+        high_ = high;
+        return *this;
+    }
+
+    /**
+     * align objects of at least 'threshold' bytes to multiples of 'bytes',
+     * or of the block size of the file system if 'bytes' is zero
+     */
+    file_access& alignment(hsize_t threshold, hsize_t bytes=0)
+    {
+        align_ = true;
+        align_threshold_ = threshold;
+        align_bytes_ = bytes;
+        return *this;
+    }
+
+    /** initial and maximum size of the metadata cache in bytes */
+    file_access& metadata_cache(std::size_t initial, std::size_t max)
+    {
+        if (initial == 0 || initial > max) {
+            throw error("file_access: invalid size of metadata cache");
+        }
+        mdc_initial_ = initial;
+        mdc_max_ = max;
+        return *this;
+    }
+
+    /** size of the buffer for reading and writing contiguous datasets in bytes */
+    file_access& sieve_buffer(std::size_t bytes)
+    {
+        sieve_ = bytes;
+        return *this;
+    }
+
+    /** size of the blocks in which metadata are allocated in the file */
+    file_access& meta_block(hsize_t bytes)
+    {
+        meta_block_ = bytes;
+        return *this;
+    }
+
+    /** size of the blocks in which small contiguous datasets are allocated in the file */
+    file_access& small_data_block(hsize_t bytes)
+    {
+        small_data_block_ = bytes;
+        return *this;
+    }
+
+    /**
+     * size of the page buffer in bytes, zero disables it, and the minimum
+     * percentages of pages reserved for metadata and raw data
+     *
+     * The page buffer is used only for files created with paged file
+     * space, see file_creation::paged(), and must hold at least one page.
+     * Other files are opened without page buffer. HDF5 versions before
+     * 1.10.1 have no page buffer, and the setting is ignored.
+     */
+    file_access& page_buffer(std::size_t bytes, unsigned int min_meta_percent=0, unsigned int min_raw_percent=0)
+    {
+        if (min_meta_percent + min_raw_percent > 100) {
+            throw error("file_access: invalid percentages of page buffer");
+        }
+        page_buffer_ = bytes;
+        page_min_meta_ = min_meta_percent;
+        page_min_raw_ = min_raw_percent;
+        return *this;
+    }
+
+    /** size of the page buffer in bytes */
+    std::size_t page_buffer() const
+    {
+        return page_buffer_;
+    }
+
+    /**
+     * default raw data chunk cache of the datasets: size in bytes, number
+     * of hash slots (preferably a prime number about 100 times the number
+     * of chunks held), and preemption policy from 0 to 1, where 1 evicts
+     * chunks first that were read or written completely
+     */
+    file_access& chunk_cache(std::size_t nbytes, std::size_t nslots, double w0=0.75)
+    {
+        if (nbytes == 0 || nslots == 0 || w0 < 0 || w0 > 1) {
+            throw error("file_access: invalid parameters of chunk cache");
+        }
+        cache_nbytes_ = nbytes;
+        cache_nslots_ = nslots;
+        cache_w0_ = w0;
+        return *this;
+    }
+
+    /** file access property list for file 'name' */
+    H5::FileAccPropList property(std::string const& name) const
+    {
+        H5::FileAccPropList fapl;
+        hid_t pl = fapl.getId();
+        if (libver_ && H5Pset_libver_bounds(pl, low_, high_) < 0) {
+            throw error("failed to set file format versions");
+        }
+        if (align_) {
+            hsize_t bytes = align_bytes_ > 0 ? align_bytes_ : detail::block_size(name);
+            if (H5Pset_alignment(pl, align_threshold_, bytes) < 0) {
+                throw error("failed to set alignment");
+            }
+        }
+        if (mdc_initial_ > 0) {
+            H5AC_cache_config_t config;
+            config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+            if (H5Pget_mdc_config(pl, &config) < 0) {
+                throw error("failed to get metadata cache configuration");
+            }
+            config.set_initial_size = 1;
+            config.initial_size = mdc_initial_;
+            config.max_size = mdc_max_;
+            config.min_size = std::min(config.min_size, mdc_initial_);
+            if (H5Pset_mdc_config(pl, &config) < 0) {
+                throw error("failed to set metadata cache configuration");
+            }
+        }
+        if (sieve_ > 0 && H5Pset_sieve_buf_size(pl, sieve_) < 0) {
+            throw error("failed to set size of sieve buffer");
+        }
+        if (meta_block_ > 0 && H5Pset_meta_block_size(pl, meta_block_) < 0) {
+            throw error("failed to set metadata block size");
+        }
+        if (small_data_block_ > 0 && H5Pset_small_data_block_size(pl, small_data_block_) < 0) {
+            throw error("failed to set small data block size");
+        }
+#if H5_VERSION_GE(1,10,1)
+        if (page_buffer_ > 0 && H5Pset_page_buffer_size(pl, page_buffer_, page_min_meta_, page_min_raw_) < 0) {
+            throw error("failed to set size of page buffer");
+        }
+#endif
+        if (cache_nbytes_ > 0 && H5Pset_cache(pl, 0, cache_nslots_, cache_nbytes_, cache_w0_) < 0) {
+            throw error("failed to set chunk cache parameters");
+        }
+        return fapl;
+    }
+
+private:
+    bool libver_;
+    H5F_libver_t low_;
+    H5F_libver_t high_;
+    bool align_;
+    hsize_t align_threshold_;
+    hsize_t align_bytes_;
+    std::size_t mdc_initial_;
+    std::size_t mdc_max_;
+    std::size_t sieve_;
+    hsize_t meta_block_;
+    hsize_t small_data_block_;
+    std::size_t page_buffer_;
+    unsigned int page_min_meta_;
+    unsigned int page_min_raw_;
+    std::size_t cache_nbytes_;
+    std::size_t cache_nslots_;
+    double cache_w0_;
+};
+
+/**
+ * File creation properties of an HDF5 file
+ *
+ * A default-constructed object keeps the defaults of the HDF5 library.
+ */
+class file_creation
+{
+public:
+    /**
+     * paged aggregation of file space
+     *
+     * Metadata and small raw data are allocated in separate pages of
+     * 'page_size' bytes, or of the block size of the file system if zero,
+     * and larger objects are aligned to pages. Opening the file and
+     * scanning many small objects then reads a few large pages instead of
+     * many scattered blocks, in particular together with a page buffer,
+     * see file_access::page_buffer(). If 'persist' is true, free space is
+     * tracked across reopening the file and reused.
+     *
+     * Files of paged file space can be read by HDF5 1.10.1 or later.
+     */
+    static file_creation paged(hsize_t page_size=0, bool persist=false)
+    {
+        file_creation creation;
+        creation.paged_ = true;
+        creation.page_size_ = page_size;
+        creation.persist_ = persist;
+        return creation;
+    }
+
+    /** defaults of the HDF5 library */
+    file_creation()
+      : paged_(false)
+      , page_size_(0)
+      , persist_(false) {}
+
+    bool is_paged() const
+    {
+        return paged_;
+    }
+
+    /** file creation property list for file 'name' */
+    H5::FileCreatPropList property(std::string const& name) const
+    {
+        H5::FileCreatPropList fcpl;
+        if (paged_) {
+#if H5_VERSION_GE(1,10,1)
+            hid_t pl = fcpl.getId();
+            // the library requires at least 512 bytes per page
+            hsize_t page_size = std::max(page_size_ > 0 ? page_size_ : detail::block_size(name), hsize_t(512));
+            if (H5Pset_file_space_strategy(pl, H5F_FSPACE_STRATEGY_PAGE, persist_, 1) < 0) {
+                throw error("failed to set file space strategy");
+            }
+            if (H5Pset_file_space_page_size(pl, page_size) < 0) {
+                throw error("failed to set file space page size");
+            }
+#else
+            throw error("paged file space requires HDF5 1.10.1 or later");
+#endif
+        }
+        return fcpl;
+    }
+
+private:
+    bool paged_;
+    hsize_t page_size_;
+    bool persist_;
+};
+
+/**
+ * open existing HDF5 file with given access flags, H5F_ACC_RDONLY or
+ * H5F_ACC_RDWR, and access properties
+ */
+inline H5::H5File open_file(
+    std::string const& name, unsigned int flags=H5F_ACC_RDONLY
+  , file_access const& access=file_access())
+{
+    if (access.page_buffer() > 0) {
+        // the library refuses a page buffer for files without paged file space
+        H5::FileAccPropList fapl = access.property(name);
+        H5::H5File file;
+        bool success = false;
+        H5E_BEGIN_TRY {
+            try {
+                file = H5::H5File(name, flags, H5::FileCreatPropList::DEFAULT, fapl);
+                success = true;
+            }
+            catch (H5::FileIException const&) {}
+        } H5E_END_TRY
+        if (success) {
+            return file;
+        }
+    }
+    file_access unbuffered(access);
+    unbuffered.page_buffer(0);
+    return H5::H5File(name, flags, H5::FileCreatPropList::DEFAULT, unbuffered.property(name));
+}
+
+/**
+ * create HDF5 file with given creation and access properties, an existing
+ * file is truncated unless 'flags' is H5F_ACC_EXCL
+ *
+ * The page buffer of 'access' is used only for files of paged file space.
+ */
+inline H5::H5File create_file(
+    std::string const& name, file_creation const& creation
+  , file_access const& access=file_access(), unsigned int flags=H5F_ACC_TRUNC)
+{
+    file_access access_(access);
+    if (!creation.is_paged()) {
+        access_.page_buffer(0);
+    }
+    return H5::H5File(name, flags, creation.property(name), access_.property(name));
+}
+
+/**
+ * create HDF5 file with given access properties and default file space,
+ * an existing file is truncated unless 'flags' is H5F_ACC_EXCL
+ */
+inline H5::H5File create_file(
+    std::string const& name, file_access const& access=file_access()
+  , unsigned int flags=H5F_ACC_TRUNC)
+{
+    return create_file(name, file_creation(), access, flags);
+}
+
+} // namespace h5xx
+
+#endif /* ! H5XX_FILE_HPP */
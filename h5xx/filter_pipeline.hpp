@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H5XX_FILTER_PIPELINE_HPP
+#define H5XX_FILTER_PIPELINE_HPP
+
+#include <h5xx/error.hpp>
+#include <h5xx/hdf5_compat.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace h5xx {
+
+/**
+ * Filter pipeline applied to the chunks of a dataset
+ *
+ * The pipeline is composed by chaining the filters in the order of
+ * application upon writing, e.g.,
+ *
+ *     filter_pipeline().shuffle().deflate(9).fletcher32()
+ *
+ * A default-constructed pipeline is empty, i.e., the data are stored
+ * uncompressed. Filters that are not available in the HDF5 library at
+ * runtime, or whose encoder is disabled, are skipped upon creation of the
+ * dataset, and the remaining filters are applied.
+ */
+class filter_pipeline
+{
+public:
+    /** byte shuffling, improves compression of floating-point data */
+    filter_pipeline& shuffle()
+    {
+        filters_.push_back(filter(H5Z_FILTER_SHUFFLE));
+        return *this;
+    }
+
+    /** GZIP compression with given level from 0 to 9 */
+    filter_pipeline& deflate(unsigned int level=compression_level)
+    {
+        if (level > 9) {
+            throw error("filter_pipeline: deflate level must be within 0 and 9");
+        }
+        filters_.push_back(filter(H5Z_FILTER_DEFLATE, level));
+        return *this;
+    }
+
+    /**
+     * scale-offset compression, lossy for floating-point data
+     *
+     * For H5Z_SO_FLOAT_DSCALE, 'factor' is the number of decimal digits
+     * retained, for H5Z_SO_INT the number of bits per integer, or
+     * H5Z_SO_INT_MINBITS_DEFAULT to let the library determine it.
+     */
+    filter_pipeline& scaleoffset(H5Z_SO_scale_type_t type, int factor)
+    {
+        filters_.push_back(filter(H5Z_FILTER_SCALEOFFSET, type, factor));
+        return *this;
+    }
+
+    /** N-bit compression of data types with unused bits */
+    filter_pipeline& nbit()
+    {
+        filters_.push_back(filter(H5Z_FILTER_NBIT));
+        return *this;
+    }
+
+    /** Fletcher32 checksum, detects corrupted chunks upon reading */
+    filter_pipeline& fletcher32()
+    {
+        filters_.push_back(filter(H5Z_FILTER_FLETCHER32));
+        return *this;
+    }
+
+    bool empty() const
+    {
+        return filters_.empty();
+    }
+
+    /** strict weak ordering by filters and their parameters */
+    bool operator<(filter_pipeline const& other) const
+    {
+        return std::lexicographical_compare(
+            filters_.begin(), filters_.end(), other.filters_.begin(), other.filters_.end()
+        );
+    }
+
+    /**
+     * add available filters to dataset creation property list, which
+     * must have chunked layout
+     */
+    void apply(H5::DSetCreatPropList& cparms) const
+    {
+        std::vector<filter>::const_iterator f;
+        for (f = filters_.begin(); f != filters_.end(); ++f) {
+            if (!is_available(f->id)) {
+                continue;
+            }
+            hid_t pl = cparms.getId();
+            herr_t err;
+            switch (f->id) {
+              case H5Z_FILTER_SHUFFLE:
+                err = H5Pset_shuffle(pl);
+                break;
+              case H5Z_FILTER_DEFLATE:
+                err = H5Pset_deflate(pl, f->param[0]);
+                break;
+              case H5Z_FILTER_SCALEOFFSET:
+                err = H5Pset_scaleoffset(pl, static_cast<H5Z_SO_scale_type_t>(f->param[0]), f->param[1]);
+                break;
+              case H5Z_FILTER_NBIT:
+                err = H5Pset_nbit(pl);
+                break;
+              default:
+                err = H5Pset_fletcher32(pl);
+                break;
+            }
+            if (err < 0) {
+                throw error("failed to set filter of dataset");
+            }
+        }
+    }
+
+    /** true if the filter is available and can encode data */
+    static bool is_available(H5Z_filter_t id)
+    {
+        unsigned int config = 0;
+        return H5Zfilter_avail(id) > 0
+            && H5Zget_filter_info(id, &config) >= 0
+            && (config & H5Z_FILTER_CONFIG_ENCODE_ENABLED);
+    }
+
+private:
+    struct filter
+    {
+        filter(H5Z_filter_t id, int param0=0, int param1=0)
+          : id(id)
+        {
+            param[0] = param0;
+            param[1] = param1;
+        }
+
+        bool operator<(filter const& other) const
+        {
+            if (id != other.id) {
+                return id < other.id;
+            }
+            return std::lexicographical_compare(param, param + 2, other.param, other.param + 2);
+        }
+
+        H5Z_filter_t id;
+        int param[2];
+    };
+
+    std::vector<filter> filters_;
+};
+
+} // namespace h5xx
+
+#endif /* ! H5XX_FILTER_PIPELINE_HPP */
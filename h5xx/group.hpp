@@ -22,6 +22,12 @@
 
 #include <h5xx/error.hpp>
 #include <h5xx/property.hpp>
+#include <h5xx/utility.hpp>
+
+#include <boost/unordered_map.hpp>
+
+#include <list>
+#include <string>
 
 namespace h5xx {
 
@@ -30,15 +36,7 @@ namespace h5xx {
  */
 inline bool exists_group(H5::CommonFG const& fg, std::string const& name)
 {
-    H5::IdComponent const& loc(dynamic_cast<H5::IdComponent const&>(fg));
-    hid_t hid;
-    H5E_BEGIN_TRY {
-        hid = H5Gopen(loc.getId(), name.c_str(), H5P_DEFAULT);
-        if (hid > 0) {
-            H5Gclose(hid);
-        }
-    } H5E_END_TRY
-    return (hid > 0);
+    return object_type(fg, name) == H5O_TYPE_GROUP;
 }
 
 /**
@@ -54,8 +52,7 @@ inline H5::Group open_group(H5::CommonFG const& fg, std::string const& path)
         group_id = H5Gopen(loc.getId(), path.c_str(), H5P_DEFAULT);
     } H5E_END_TRY
     if (group_id < 0) {
-        H5::PropList pl = create_intermediate_group_property();
-        group_id = H5Gcreate(loc.getId(), path.c_str(), pl.getId(), H5P_DEFAULT, H5P_DEFAULT);
+        group_id = H5Gcreate(loc.getId(), path.c_str(), detail::link_create_property(), H5P_DEFAULT, H5P_DEFAULT);
     }
     if (group_id < 0) {
         throw error("failed to create group \"" + path + "\"");
@@ -63,6 +60,106 @@ inline H5::Group open_group(H5::CommonFG const& fg, std::string const& path)
     return H5::Group(group_id);
 }
 
+/**
+ * Cache of open group handles of a file, keyed by absolute path
+ *
+ * open() resolves a path by a hash lookup if the group was opened before,
+ * otherwise it opens or creates the group within its (cached) parent
+ * group, so that only the last path component is looked up in the file.
+ * Datasets are created within cached groups by passing the group and the
+ * name of the dataset, e.g.,
+ *
+ *     create_chunked_dataset<T>(cache.open("/particles/all"), "position", …)
+ *
+ * Groups removed from the file by unlink() are evicted from the cache,
+ * groups unlinked otherwise must be evicted by invalidate().
+ */
+class group_cache
+{
+public:
+    /** cache groups of the file containing the given file or group */
+    explicit group_cache(H5::CommonFG const& fg)
+      : root_(open_group(fg, "/")) {}
+
+    /**
+     * open or create group, relative paths are taken relative to the root
+     * group of the file
+     */
+    H5::Group open(std::string const& path)
+    {
+        std::string key = normalize(path);
+        if (key == "/") {
+            return root_;
+        }
+        map_type::const_iterator group = groups_.find(key);
+        if (group != groups_.end() && H5Iis_valid(group->second.getId()) > 0) {
+            return group->second;
+        }
+        std::string::size_type slash = key.rfind('/');
+        H5::Group parent = open(key.substr(0, slash));
+        return groups_[key] = open_group(parent, key.substr(slash + 1));
+    }
+
+    /**
+     * remove link to group or other object from the file and evict the
+     * group and its subgroups from the cache
+     */
+    void unlink(std::string const& path)
+    {
+        std::string key = normalize(path);
+        if (H5Ldelete(root_.getId(), key.c_str(), H5P_DEFAULT) < 0) {
+            throw error("failed to unlink object \"" + key + "\"");
+        }
+        invalidate(key);
+    }
+
+    /** evict group and its subgroups from the cache */
+    void invalidate(std::string const& path)
+    {
+        std::string key = normalize(path);
+        std::string prefix = (key == "/") ? key : key + "/";
+        for (map_type::iterator group = groups_.begin(); group != groups_.end(); ) {
+            if (group->first == key || group->first.compare(0, prefix.size(), prefix) == 0) {
+                group = groups_.erase(group);
+            }
+            else {
+                ++group;
+            }
+        }
+    }
+
+    /** evict all groups from the cache */
+    void clear()
+    {
+        groups_.clear();
+    }
+
+    /** number of cached groups, excluding the root group */
+    std::size_t size() const
+    {
+        return groups_.size();
+    }
+
+    /** absolute path without empty components, e.g., "/one/two" for "one//two/" */
+    static std::string normalize(std::string const& path)
+    {
+        std::list<std::string> names = split_path(path);
+        std::string key;
+        for (std::list<std::string>::const_iterator name = names.begin(); name != names.end(); ++name) {
+            if (*name != ".") {
+                key += "/" + *name;
+            }
+        }
+        return key.empty() ? "/" : key;
+    }
+
+private:
+    typedef boost::unordered_map<std::string, H5::Group> map_type;
+
+    H5::Group root_;
+    map_type groups_;
+};
+
 } // namespace h5xx
 
 #endif /* ! H5XX_GROUP_HPP */
@@ -26,10 +26,13 @@ namespace h5xx {
 }
 
 #include <h5xx/attribute.hpp>
+#include <h5xx/attribute_batch.hpp>
 #include <h5xx/ctype.hpp>
 #include <h5xx/dataset.hpp>
 #include <h5xx/chunked_dataset.hpp>
+#include <h5xx/chunked_appender.hpp>
 #include <h5xx/exception.hpp>
+#include <h5xx/file.hpp>
 #include <h5xx/group.hpp>
 #include <h5xx/utility.hpp>
 
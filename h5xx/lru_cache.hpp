@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H5XX_LRU_CACHE_HPP
+#define H5XX_LRU_CACHE_HPP
+
+#include <h5xx/hdf5_compat.hpp>
+
+#include <boost/noncopyable.hpp>
+#ifdef H5_HAVE_THREADSAFE
+# include <boost/thread/locks.hpp>
+# include <boost/thread/mutex.hpp>
+#endif
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <utility>
+
+namespace h5xx {
+namespace detail {
+
+/**
+ * Map of bounded size, which evicts the least recently used entry if full
+ *
+ * A thread-safe HDF5 library may be called from several threads at once,
+ * the cache is then guarded by a mutex. Otherwise, all callers of HDF5
+ * are serialized anyway, and so are the users of the cache.
+ */
+template <typename Key, typename Value>
+class lru_cache
+  : boost::noncopyable
+{
+public:
+    typedef Key key_type;
+    typedef Value value_type;
+
+    explicit lru_cache(std::size_t max_size)
+      : max_size_(max_size) {}
+
+    /**
+     * look up value of given key and mark the entry as most recently used,
+     * return false if there is no such entry
+     */
+    bool find(key_type const& key, value_type& value)
+    {
+        lock_type lock(mutex_);
+        typename index_type::iterator i = index_.find(key);
+        if (i == index_.end()) {
+            return false;
+        }
+        entries_.splice(entries_.end(), entries_, i->second);
+        value = i->second->second;
+        return true;
+    }
+
+    /**
+     * insert value of given key as most recently used entry, and evict the
+     * least recently used entry if the cache is full
+     *
+     * If another caller has inserted the key meanwhile, that value is kept.
+     * Returns the cached value.
+     */
+    value_type insert(key_type const& key, value_type const& value)
+    {
+        lock_type lock(mutex_);
+        typename index_type::iterator i = index_.find(key);
+        if (i != index_.end()) {
+            entries_.splice(entries_.end(), entries_, i->second);
+            return i->second->second;
+        }
+        if (!entries_.empty() && index_.size() >= max_size_) {
+            index_.erase(entries_.front().first);
+            entries_.pop_front();
+        }
+        entries_.push_back(std::make_pair(key, value));
+        index_.insert(std::make_pair(key, --entries_.end()));
+        return value;
+    }
+
+    /** number of entries */
+    std::size_t size() const
+    {
+        lock_type lock(mutex_);
+        return index_.size();
+    }
+
+private:
+#ifdef H5_HAVE_THREADSAFE
+    typedef boost::mutex mutex_type;
+    typedef boost::lock_guard<boost::mutex> lock_type;
+#else
+    struct mutex_type {};
+    struct lock_type
+    {
+        explicit lock_type(mutex_type&) {}
+    };
+#endif
+
+    /** entries in order of use, the least recently used first */
+    typedef std::list<std::pair<key_type, value_type> > list_type;
+    typedef std::map<key_type, typename list_type::iterator> index_type;
+
+    std::size_t const max_size_;
+    list_type entries_;
+    index_type index_;
+    mutable mutex_type mutex_;
+};
+
+} // namespace detail
+} // namespace h5xx
+
+#endif /* ! H5XX_LRU_CACHE_HPP */
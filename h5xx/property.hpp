@@ -21,7 +21,16 @@
 #define H5XX_PROPERTY_HPP
 
 #include <h5xx/error.hpp>
+#include <h5xx/filter_pipeline.hpp>
 #include <h5xx/hdf5_compat.hpp>
+#include <h5xx/lru_cache.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace h5xx {
 
@@ -41,6 +50,224 @@ inline H5::PropList create_intermediate_group_property()
     return H5::PropList(pl);
 }
 
+namespace detail {
+
+/**
+ * Owner of a property list id, which is closed upon destruction
+ */
+class property_handle
+{
+public:
+    /** take ownership of property list id */
+    explicit property_handle(hid_t hid)
+      : hid_(hid)
+    {
+        if (hid_ < 0) {
+            throw error("failed to create HDF5 property list");
+        }
+    }
+
+    ~property_handle()
+    {
+        // the HDF5 library may have been shut down already
+        H5E_BEGIN_TRY {
+            H5Pclose(hid_);
+        } H5E_END_TRY
+    }
+
+    hid_t hid() const
+    {
+        return hid_;
+    }
+
+private:
+    property_handle(property_handle const&);
+    property_handle& operator=(property_handle const&);
+
+    hid_t const hid_;
+};
+
+/**
+ * link creation property list with the create intermediate group property
+ *
+ * The property list is created upon the first call and shared by all
+ * callers; it must neither be closed nor modified.
+ */
+inline hid_t link_create_property()
+{
+    static property_handle const pl(H5Pcreate(H5P_LINK_CREATE));
+    static herr_t const err = H5Pset_create_intermediate_group(pl.hid(), 1);
+    if (err < 0) {
+        throw error("failed to set group intermediate creation property");
+    }
+    return pl.hid();
+}
+
+/**
+ * dataset creation property list for given chunk dimensions and filters,
+ * or for contiguous layout if 'chunk_dim' is empty
+ *
+ * The property lists are created upon the first request of a combination
+ * and shared by all callers; they must neither be closed nor modified.
+ * The cache holds the most recently used lists, a list evicted from the
+ * cache is closed once the last returned handle is released.
+ */
+inline boost::shared_ptr<property_handle const>
+dataset_create_property(std::vector<hsize_t> const& chunk_dim, filter_pipeline const& filters)
+{
+    typedef std::pair<std::vector<hsize_t>, filter_pipeline> key_type;
+    typedef boost::shared_ptr<property_handle const> handle_type;
+    // bound memory for applications creating datasets of many shapes
+    static lru_cache<key_type, handle_type> cache(64);
+
+    key_type key(chunk_dim, chunk_dim.empty() ? filter_pipeline() : filters);
+    handle_type pl;
+    if (!cache.find(key, pl)) {
+        H5::DSetCreatPropList cparms;
+        if (!chunk_dim.empty()) {
+            cparms.setChunk(chunk_dim.size(), &*chunk_dim.begin());
+            filters.apply(cparms);
+        }
+        pl = cache.insert(key, handle_type(new property_handle(H5Pcopy(cparms.getId()))));
+    }
+    return pl;
+}
+
+} // namespace detail
+
+/**
+ * treatment of an existing dataset upon creation of a dataset of the same name
+ */
+enum create_mode
+{
+    /** delete the existing dataset and create a new one */
+    replace_existing
+    /**
+     * keep the existing dataset if data type, rank, maximum shape, chunk
+     * shape and filters match, and truncate chunked datasets of unlimited
+     * size; otherwise replace the dataset
+     *
+     * HDF5 does not reclaim the space of deleted datasets, so reusing
+     * datasets keeps the file size constant if the same datasets are
+     * written repeatedly, e.g., checkpoints.
+     */
+  , reuse_existing
+};
+
+namespace detail {
+
+/**
+ * compare filter pipelines of existing dataset and creation property list,
+ * the filter parameters set by the library upon creation are ignored
+ */
+inline bool has_filters(hid_t dataset_cparms, hid_t cparms)
+{
+    int nfilters = H5Pget_nfilters(cparms);
+    if (nfilters < 0 || H5Pget_nfilters(dataset_cparms) != nfilters) {
+        return false;
+    }
+    for (int i = 0; i < nfilters; ++i) {
+        unsigned int flags, dataset_flags, config;
+        unsigned int values[8], dataset_values[8];
+        size_t nvalues = 8, dataset_nvalues = 8;
+        H5Z_filter_t id = H5Pget_filter2(cparms, i, &flags, &nvalues, values, 0, NULL, &config);
+        H5Z_filter_t dataset_id = H5Pget_filter2(
+            dataset_cparms, i, &dataset_flags, &dataset_nvalues, dataset_values, 0, NULL, &config
+        );
+        if (id < 0 || id != dataset_id || flags != dataset_flags || nvalues > dataset_nvalues
+            || !std::equal(values, values + std::min(nvalues, size_t(8)), dataset_values)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * open existing dataset 'name' if it is compatible with the given data type,
+ * dataspace and creation property list, and set its extent to that of the
+ * dataspace; return a negative value otherwise
+ */
+inline hid_t reuse_dataset(hid_t loc, std::string const& name, hid_t type, hid_t space, hid_t cparms)
+{
+    hid_t dataset = -1;
+    H5E_BEGIN_TRY {
+        if (H5Lexists(loc, name.c_str(), H5P_DEFAULT) > 0) {
+            dataset = H5Dopen(loc, name.c_str(), H5P_DEFAULT);
+        }
+    } H5E_END_TRY
+    if (dataset < 0) {
+        return -1;
+    }
+
+    hid_t dataset_type = H5Dget_type(dataset);
+    hid_t dataset_space = H5Dget_space(dataset);
+    hid_t dataset_cparms = H5Dget_create_plist(dataset);
+    bool match = dataset_type >= 0 && dataset_space >= 0 && dataset_cparms >= 0
+        && H5Tequal(dataset_type, type) > 0
+        && H5Sget_simple_extent_type(dataset_space) == H5Sget_simple_extent_type(space)
+        && H5Pget_layout(dataset_cparms) == H5Pget_layout(cparms);
+
+    int rank = match ? H5Sget_simple_extent_ndims(space) : -1;
+    std::vector<hsize_t> dim(rank > 0 ? rank : 0), max_dim(dim), dataset_dim(dim), dataset_max_dim(dim);
+    if (rank > 0) {
+        H5Sget_simple_extent_dims(space, &*dim.begin(), &*max_dim.begin());
+        match = H5Sget_simple_extent_ndims(dataset_space) == rank
+            && H5Sget_simple_extent_dims(dataset_space, &*dataset_dim.begin(), &*dataset_max_dim.begin()) == rank
+            && dataset_max_dim == max_dim;
+        // compare chunk shape
+        if (match && H5Pget_layout(cparms) == H5D_CHUNKED) {
+            std::vector<hsize_t> chunk_dim(rank), dataset_chunk_dim(rank);
+            match = H5Pget_chunk(cparms, rank, &*chunk_dim.begin()) == rank
+                && H5Pget_chunk(dataset_cparms, rank, &*dataset_chunk_dim.begin()) == rank
+                && dataset_chunk_dim == chunk_dim;
+        }
+    }
+    match = match && has_filters(dataset_cparms, cparms);
+
+    // truncate or extend dataset to requested extent
+    if (match && rank > 0 && dataset_dim != dim) {
+        match = H5Dset_extent(dataset, &*dim.begin()) >= 0;
+    }
+
+    if (dataset_type >= 0) H5Tclose(dataset_type);
+    if (dataset_space >= 0) H5Sclose(dataset_space);
+    if (dataset_cparms >= 0) H5Pclose(dataset_cparms);
+    if (!match) {
+        H5Dclose(dataset);
+        return -1;
+    }
+    return dataset;
+}
+
+/**
+ * create dataset 'name' with given data type, dataspace and creation
+ * property list, including missing intermediate groups, and treat an
+ * existing dataset according to 'mode'
+ */
+inline hid_t create_dataset(
+    hid_t loc, std::string const& name, hid_t type, hid_t space, hid_t cparms
+  , create_mode mode=replace_existing)
+{
+    if (mode == reuse_existing) {
+        hid_t dataset = reuse_dataset(loc, name, type, space, cparms);
+        if (dataset >= 0) {
+            return dataset;
+        }
+    }
+
+    // remove dataset if it exists
+    H5E_BEGIN_TRY {
+        H5Ldelete(loc, name.c_str(), H5P_DEFAULT);
+    } H5E_END_TRY
+
+    hid_t dataset = H5Dcreate(loc, name.c_str(), type, space, link_create_property(), cparms, H5P_DEFAULT);
+    if (dataset < 0) {
+        throw error("failed to create dataset \"" + name + "\"");
+    }
+    return dataset;
+}
+
+} // namespace detail
 } // namespace h5xx
 
 #endif /* ! H5XX_PROPERTY_HPP */
@@ -0,0 +1,187 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H5XX_THREAD_POOL_HPP
+#define H5XX_THREAD_POOL_HPP
+
+#include <h5xx/error.hpp>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+
+namespace h5xx {
+namespace detail {
+
+/**
+ * task executed by the thread pool
+ *
+ * Tasks must not call the HDF5 library, which is not thread-safe in general.
+ */
+class pool_task
+  : boost::noncopyable
+{
+public:
+    pool_task()
+      : done_(false)
+      , failed_(false) {}
+
+    virtual ~pool_task() {}
+
+    virtual void run() = 0;
+
+private:
+    friend class thread_pool;
+
+    bool done_;
+    bool failed_;
+    std::string error_;
+};
+
+/**
+ * Fixed-size pool of worker threads processing tasks in order of submission
+ */
+class thread_pool
+  : boost::noncopyable
+{
+public:
+    typedef boost::shared_ptr<pool_task> task_ptr;
+
+    /**
+     * start given number of worker threads, or one thread per hardware
+     * thread for threads = 0
+     */
+    explicit thread_pool(unsigned int threads=0)
+      : stop_(false)
+    {
+        if (threads == 0) {
+            threads = std::max(boost::thread::hardware_concurrency(), 1U);
+        }
+        for (unsigned int i = 0; i < threads; ++i) {
+            threads_.create_thread(worker(this));
+        }
+    }
+
+    /** finish queued tasks and terminate worker threads */
+    ~thread_pool()
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        queued_.notify_all();
+        threads_.join_all();
+    }
+
+    /** queue task for execution */
+    void submit(task_ptr const& task)
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            queue_.push_back(task);
+        }
+        queued_.notify_one();
+    }
+
+    /**
+     * block until task has finished, re-throw an error of the task as
+     * h5xx::error
+     */
+    void wait(pool_task const& task)
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        while (!task.done_) {
+            done_.wait(lock);
+        }
+        if (task.failed_) {
+            throw error(task.error_);
+        }
+    }
+
+    /** number of worker threads */
+    unsigned int size() const
+    {
+        return threads_.size();
+    }
+
+private:
+    struct worker
+    {
+        worker(thread_pool* pool) : pool(pool) {}
+        void operator()() { pool->run(); }
+        thread_pool* pool;
+    };
+
+    void run()
+    {
+        for (;;) {
+            task_ptr task;
+            {
+                boost::unique_lock<boost::mutex> lock(mutex_);
+                while (queue_.empty() && !stop_) {
+                    queued_.wait(lock);
+                }
+                if (queue_.empty()) {
+                    return;
+                }
+                task = queue_.front();
+                queue_.pop_front();
+            }
+
+            std::string what;
+            bool failed = true;
+            try {
+                task->run();
+                failed = false;
+            }
+            catch (std::exception const& e) {
+                what = e.what();
+            }
+            catch (...) {
+                what = "unknown error";
+            }
+
+            {
+                boost::unique_lock<boost::mutex> lock(mutex_);
+                task->done_ = true;
+                task->failed_ = failed;
+                task->error_ = what;
+            }
+            done_.notify_all();
+        }
+    }
+
+    std::deque<task_ptr> queue_;
+    bool stop_;
+    boost::mutex mutex_;
+    boost::condition_variable queued_;
+    boost::condition_variable done_;
+    boost::thread_group threads_;
+};
+
+} // namespace detail
+} // namespace h5xx
+
+#endif /* ! H5XX_THREAD_POOL_HPP */
@@ -24,12 +24,20 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/array.hpp>
+#include <boost/mpl/and.hpp>
+#include <boost/mpl/or.hpp>
 #include <boost/multi_array.hpp>
 #include <boost/type_traits/is_fundamental.hpp>
 #include <boost/type_traits/is_same.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <list>
+#include <map>
+#include <numeric>
+#include <vector>
 
 namespace h5xx {
 
@@ -86,20 +94,129 @@ inline void link(H5::H5Object const& object, H5::Group const& group, std::string
     }
 }
 
+namespace detail {
+
 /**
- * determine whether dataset exists in file or group
+ * determine whether link exists, return false also if a path component
+ * other than the last one is not a group
  */
-inline bool exists_dataset(H5::CommonFG const& fg, std::string const& name)
+inline bool exists_link(hid_t loc, std::string const& path)
 {
-    H5::IdComponent const& loc(dynamic_cast<H5::IdComponent const&>(fg));
-    hid_t hid;
+    htri_t tri;
     H5E_BEGIN_TRY {
-        hid = H5Dopen(loc.getId(), name.c_str(), H5P_DEFAULT);
-        if (hid > 0) {
-            H5Dclose(hid);
-        }
+        tri = H5Lexists(loc, path.c_str(), H5P_DEFAULT);
+    } H5E_END_TRY
+    return tri > 0;
+}
+
+/**
+ * determine type of the object linked to by 'path', which exists
+ * (including its parent groups), or H5O_TYPE_UNKNOWN for dangling links
+ *
+ * Only the object header is read, not the messages describing the object.
+ */
+inline H5O_type_t linked_object_type(hid_t loc, std::string const& path)
+{
+    herr_t err;
+    H5O_type_t type = H5O_TYPE_UNKNOWN;
+#if H5_VERSION_GE(1,12,0)
+    H5O_info2_t info;
+    H5E_BEGIN_TRY {
+        err = H5Oget_info_by_name3(loc, path.c_str(), &info, H5O_INFO_BASIC, H5P_DEFAULT);
     } H5E_END_TRY
-    return (hid > 0);
+#elif H5_VERSION_GE(1,10,3)
+    H5O_info_t info;
+    H5E_BEGIN_TRY {
+        err = H5Oget_info_by_name2(loc, path.c_str(), &info, H5O_INFO_BASIC, H5P_DEFAULT);
+    } H5E_END_TRY
+#else
+    H5O_info_t info;
+    H5E_BEGIN_TRY {
+        err = H5Oget_info_by_name(loc, path.c_str(), &info, H5P_DEFAULT);
+    } H5E_END_TRY
+#endif
+    if (err >= 0) {
+        type = info.type;
+    }
+    return type;
+}
+
+/**
+ * walk the path component by component with H5Lexists and return the
+ * object type, or H5O_TYPE_UNKNOWN if the object does not exist
+ *
+ * If given, 'links' caches the existence of the links of the path
+ * prefixes across calls.
+ */
+inline H5O_type_t object_type(hid_t loc, std::string const& path, std::map<std::string, bool>* links=NULL)
+{
+    std::list<std::string> names = split_path(path);
+    if (names.empty()) {
+        // root group for absolute paths, invalid otherwise
+        return (!path.empty() && path[0] == '/') ? linked_object_type(loc, "/") : H5O_TYPE_UNKNOWN;
+    }
+
+    std::string prefix = (path[0] == '/') ? "/" : "";
+    for (std::list<std::string>::const_iterator name = names.begin(); name != names.end(); ++name) {
+        if (!prefix.empty() && prefix != "/") {
+            prefix += "/";
+        }
+        prefix += *name;
+        bool exists;
+        std::map<std::string, bool>::const_iterator link;
+        if (links && (link = links->find(prefix)) != links->end()) {
+            exists = link->second;
+        }
+        else {
+            exists = exists_link(loc, prefix);
+            if (links) {
+                links->insert(std::make_pair(prefix, exists));
+            }
+        }
+        if (!exists) {
+            return H5O_TYPE_UNKNOWN;
+        }
+    }
+    return linked_object_type(loc, prefix);
+}
+
+} // namespace detail
+
+/**
+ * return type of object in file or group, or H5O_TYPE_UNKNOWN if it does not exist
+ *
+ * The path is resolved link by link with H5Lexists, the object is not opened.
+ */
+inline H5O_type_t object_type(H5::CommonFG const& fg, std::string const& path)
+{
+    H5::IdComponent const& loc(dynamic_cast<H5::IdComponent const&>(fg));
+    return detail::object_type(loc.getId(), path);
+}
+
+/**
+ * return types of objects at given paths in file or group, H5O_TYPE_UNKNOWN
+ * for non-existing objects
+ *
+ * The existence of common path prefixes is checked only once.
+ */
+inline std::vector<H5O_type_t> object_types(H5::CommonFG const& fg, std::vector<std::string> const& paths)
+{
+    H5::IdComponent const& loc(dynamic_cast<H5::IdComponent const&>(fg));
+    std::map<std::string, bool> links;
+    std::vector<H5O_type_t> types;
+    types.reserve(paths.size());
+    for (std::vector<std::string>::const_iterator path = paths.begin(); path != paths.end(); ++path) {
+        types.push_back(detail::object_type(loc.getId(), *path, &links));
+    }
+    return types;
+}
+
+/**
+ * determine whether dataset exists in file or group
+ */
+inline bool exists_dataset(H5::CommonFG const& fg, std::string const& name)
+{
+    return object_type(fg, name) == H5O_TYPE_DATASET;
 }
 
 /**
@@ -128,6 +245,45 @@ template <typename T, size_t size, typename Alloc>
 struct is_multi_array<boost::multi_array<T, size, Alloc> >
   : boost::true_type {};
 
+/**
+ * Data type is a reference to or a view of a MultiArray, with arbitrary
+ * strides in general
+ */
+template <typename T>
+struct is_multi_array_view
+  : boost::false_type {};
+
+template <typename T, size_t size, typename TPtr>
+struct is_multi_array_view<boost::const_multi_array_ref<T, size, TPtr> >
+  : boost::true_type {};
+
+template <typename T, size_t size>
+struct is_multi_array_view<boost::multi_array_ref<T, size> >
+  : boost::true_type {};
+
+template <typename T, size_t size, typename TPtr>
+struct is_multi_array_view<boost::detail::multi_array::const_multi_array_view<T, size, TPtr> >
+  : boost::true_type {};
+
+template <typename T, size_t size>
+struct is_multi_array_view<boost::detail::multi_array::multi_array_view<T, size> >
+  : boost::true_type {};
+
+/**
+ * Data type is a mutable reference to or view of a MultiArray
+ */
+template <typename T>
+struct is_mutable_multi_array_view
+  : boost::false_type {};
+
+template <typename T, size_t size>
+struct is_mutable_multi_array_view<boost::multi_array_ref<T, size> >
+  : boost::true_type {};
+
+template <typename T, size_t size>
+struct is_mutable_multi_array_view<boost::detail::multi_array::multi_array_view<T, size> >
+  : boost::true_type {};
+
 /**
  * Data type is a Random Access Container
  *
@@ -145,10 +301,10 @@ struct is_vector<std::vector<T, Alloc> >
  * check data type of abstract dataset (dataset or attribute)
  */
 template <typename T>
-inline typename boost::enable_if<boost::is_fundamental<T>, bool>::type
+inline typename boost::enable_if<has_ctype<T>, bool>::type
 has_type(H5::AbstractDs const& ds)
 {
-    return ds.getDataType() == ctype<T>::hid();
+    return H5Tequal(ds.getDataType().getId(), ctype<T>::hid()) > 0;
 }
 
 template <typename T>
@@ -242,7 +398,7 @@ has_extent(H5::DataSpace const& dataspace)
 }
 
 template <typename T, hsize_t extra_rank>
-inline typename boost::enable_if<is_multi_array<T>, bool>::type
+inline typename boost::enable_if<boost::mpl::or_<is_multi_array<T>, is_multi_array_view<T> >, bool>::type
 has_extent(H5::DataSpace const& dataspace, typename T::size_type const* shape)
 {
     enum { rank = T::dimensionality };
@@ -263,7 +419,7 @@ has_extent(H5::DataSpace const& dataspace)
 }
 
 template <typename T>
-inline typename boost::enable_if<is_multi_array<T>, bool>::type
+inline typename boost::enable_if<boost::mpl::or_<is_multi_array<T>, is_multi_array_view<T> >, bool>::type
 has_extent(H5::DataSpace const& dataspace, typename T::size_type const* shape)
 {
     return has_extent<T, 0>(dataspace);
@@ -312,6 +468,333 @@ inline hsize_t elements(H5::AbstractDs const& ds)
     return elements(ds.getSpace());
 }
 
+namespace detail {
+
+/**
+ * true if the strides of a multi_array view are positive and nested, i.e.,
+ * each stride is a multiple of the next inner one and the dimensions do
+ * not overlap, or if the view is empty
+ */
+template <typename T>
+inline typename boost::enable_if<is_multi_array_view<T>, bool>::type
+has_regular_strides(T const& data)
+{
+    enum { rank = T::dimensionality };
+    typename T::size_type const* shape = data.shape();
+    typename T::index const* stride = data.strides();
+    if (data.num_elements() == 0) {
+        return true;
+    }
+    bool regular = stride[rank - 1] > 0;
+    for (int i = 0; regular && i < rank - 1; ++i) {
+        regular = stride[i] > 0 && stride[i] % stride[i + 1] == 0
+            && stride[i] >= stride[i + 1] * std::ptrdiff_t(shape[i + 1]);
+    }
+    return regular;
+}
+
+/**
+ * memory dataspace selecting the elements of a multi_array view with
+ * regular strides in the order of its indices, and set 'base' to the
+ * element of lowest address
+ *
+ * The view is mapped to a regular hyperslab, the data is not copied.
+ */
+template <typename T>
+inline typename boost::enable_if<is_multi_array_view<T>, H5::DataSpace>::type
+memory_dataspace(T const& data, typename T::element const*& base)
+{
+    enum { rank = T::dimensionality };
+    typename T::size_type const* shape = data.shape();
+    typename T::index const* stride = data.strides();
+    typename T::index const* index_base = data.index_bases();
+    if (!has_regular_strides(data)) {
+        throw error("multi_array view has irregular strides");
+    }
+
+    // offsets of the first element and of the element of highest address
+    std::ptrdiff_t first = 0, high = 0;
+    for (int i = 0; i < rank; ++i) {
+        first += index_base[i] * stride[i];
+        high += std::ptrdiff_t(shape[i] > 0 ? shape[i] - 1 : 0) * stride[i];
+    }
+    base = data.origin() + first;
+
+    boost::array<hsize_t, rank> dim;
+    std::copy(shape, shape + rank, dim.begin());
+    if (data.num_elements() == 0) {
+        return H5::DataSpace(rank, &*dim.begin());
+    }
+
+    // row-major memory dataspace whose dimension i has stride[i]
+    boost::array<hsize_t, rank> mem_dim, start, step;
+    mem_dim[0] = shape[0];
+    for (int i = 1; i < rank; ++i) {
+        mem_dim[i] = stride[i - 1] / stride[i];
+    }
+    mem_dim[rank - 1] = (rank > 1) ? stride[rank - 2] : high + 1;
+    std::fill(start.begin(), start.end(), 0);
+    std::fill(step.begin(), step.end(), 1);
+    step[rank - 1] = stride[rank - 1];
+    H5::DataSpace dataspace(rank, &*mem_dim.begin());
+    dataspace.selectHyperslab(H5S_SELECT_SET, &*dim.begin(), &*start.begin(), &*step.begin());
+    return dataspace;
+}
+
+/**
+ * Offsets of the elements of a multi_array view relative to its origin,
+ * visited in the order of its indices from a given row of the outermost
+ * dimension on
+ */
+template <typename T>
+class view_cursor
+{
+public:
+    view_cursor(T const& data, std::size_t first)
+      : shape_(data.shape())
+      , stride_(data.strides())
+      , offset_(0)
+    {
+        std::fill(index_.begin(), index_.end(), 0);
+        index_[0] = first;
+        for (int i = 0; i < rank; ++i) {
+            offset_ += (data.index_bases()[i] + std::ptrdiff_t(index_[i])) * stride_[i];
+        }
+    }
+
+    std::ptrdiff_t offset() const
+    {
+        return offset_;
+    }
+
+    void next()
+    {
+        for (int i = rank - 1; i >= 0; --i) {
+            offset_ += stride_[i];
+            if (++index_[i] < shape_[i] || i == 0) {
+                return;
+            }
+            offset_ -= std::ptrdiff_t(shape_[i]) * stride_[i];
+            index_[i] = 0;
+        }
+    }
+
+private:
+    enum { rank = T::dimensionality };
+
+    typename T::size_type const* shape_;
+    typename T::index const* stride_;
+    boost::array<std::size_t, rank> index_;
+    std::ptrdiff_t offset_;
+};
+
+/** number of elements of a row of a multi_array view along the outermost dimension */
+template <typename T>
+inline std::size_t row_elements(T const& data)
+{
+    return std::accumulate(data.shape() + 1, data.shape() + T::dimensionality, std::size_t(1), std::multiplies<std::size_t>());
+}
+
+/** copy rows [first, first + rows) of a multi_array view to a dense array in row-major order */
+template <typename T>
+inline void gather_rows(T const& data, std::size_t first, std::size_t rows, typename T::element* buffer)
+{
+    view_cursor<T> cursor(data, first);
+    for (std::size_t n = rows * row_elements(data); n > 0; --n, cursor.next()) {
+        *buffer++ = data.origin()[cursor.offset()];
+    }
+}
+
+/** copy dense array in row-major order to rows [first, first + rows) of a multi_array view */
+template <typename T>
+inline void scatter_rows(typename T::element const* buffer, T& data, std::size_t first, std::size_t rows)
+{
+    view_cursor<T> cursor(data, first);
+    for (std::size_t n = rows * row_elements(data); n > 0; --n, cursor.next()) {
+        data.origin()[cursor.offset()] = *buffer++;
+    }
+}
+
+/**
+ * Map the data type of a dataset, or the record type of a chunked dataset,
+ * to its element type and rank and give access to the raw data of a
+ * record, which is laid out contiguously for all supported types.
+ *
+ * has_shape() checks a record against the shape of a dataset record,
+ * is_valid_shape() checks whether the record type can hold records of the
+ * given shape at all, and resize() adapts a record to the given shape.
+ */
+template <typename T, typename Enable = void>
+struct record_traits;
+
+template <typename T>
+struct record_traits<T, typename boost::enable_if<has_ctype<T> >::type>
+{
+    typedef T value_type;
+    enum { rank = 0 };
+
+    static value_type const* data(T const& record)
+    {
+        return &record;
+    }
+
+    static value_type* data(T& record)
+    {
+        return &record;
+    }
+
+    static bool has_shape(T const&, hsize_t const*)
+    {
+        return true;
+    }
+
+    static bool is_valid_shape(hsize_t const*)
+    {
+        return true;
+    }
+
+    static void resize(T&, hsize_t const*) {}
+};
+
+template <typename T>
+struct record_traits<T, typename boost::enable_if<boost::mpl::and_<
+        is_array<T>, has_ctype<typename T::value_type>
+    > >::type>
+{
+    typedef typename T::value_type value_type;
+    enum { rank = 1 };
+
+    static value_type const* data(T const& record)
+    {
+        return &*record.begin();
+    }
+
+    static value_type* data(T& record)
+    {
+        return &*record.begin();
+    }
+
+    static bool has_shape(T const&, hsize_t const* shape)
+    {
+        return is_valid_shape(shape);
+    }
+
+    static bool is_valid_shape(hsize_t const* shape)
+    {
+        return shape[0] == T::static_size;
+    }
+
+    static void resize(T&, hsize_t const*) {}
+};
+
+template <typename T>
+struct record_traits<T, typename boost::enable_if<is_multi_array<T> >::type>
+{
+    typedef typename T::element value_type;
+    enum { rank = T::dimensionality };
+
+    static value_type const* data(T const& record)
+    {
+        return record.origin();
+    }
+
+    static value_type* data(T& record)
+    {
+        return record.origin();
+    }
+
+    static bool has_shape(T const& record, hsize_t const* shape)
+    {
+        return std::equal(shape, shape + rank, record.shape());
+    }
+
+    static bool is_valid_shape(hsize_t const*)
+    {
+        return true;
+    }
+
+    /** resize record if necessary, may allocate new memory */
+    static void resize(T& record, hsize_t const* shape)
+    {
+        if (!has_shape(record, shape)) {
+            boost::array<typename T::size_type, rank> shape_;
+            std::copy(shape, shape + rank, shape_.begin());
+            record.resize(shape_);
+        }
+    }
+};
+
+template <typename T>
+struct record_traits<T, typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, has_ctype<typename T::value_type>
+    > >::type>
+{
+    typedef typename T::value_type value_type;
+    enum { rank = 1 };
+
+    static value_type const* data(T const& record)
+    {
+        return &*record.begin();
+    }
+
+    static value_type* data(T& record)
+    {
+        return &*record.begin();
+    }
+
+    static bool has_shape(T const& record, hsize_t const* shape)
+    {
+        return shape[0] == record.size();
+    }
+
+    static bool is_valid_shape(hsize_t const*)
+    {
+        return true;
+    }
+
+    static void resize(T& record, hsize_t const* shape)
+    {
+        record.resize(shape[0]);
+    }
+};
+
+template <typename T>
+struct record_traits<T, typename boost::enable_if<boost::mpl::and_<
+        is_vector<T>, is_array<typename T::value_type>
+    > >::type>
+{
+    typedef typename T::value_type array_type;
+    typedef typename array_type::value_type value_type;
+    enum { rank = 2 };
+
+    static value_type const* data(T const& record)
+    {
+        return &*record.begin()->begin();
+    }
+
+    static value_type* data(T& record)
+    {
+        return &*record.begin()->begin();
+    }
+
+    static bool has_shape(T const& record, hsize_t const* shape)
+    {
+        return shape[0] == record.size() && is_valid_shape(shape);
+    }
+
+    static bool is_valid_shape(hsize_t const* shape)
+    {
+        return shape[1] == array_type::static_size;
+    }
+
+    static void resize(T& record, hsize_t const* shape)
+    {
+        record.resize(shape[0]);
+    }
+};
+
+} // namespace detail
+
 /**
  * return if a handle id is valid or not
  */
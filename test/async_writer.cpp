@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE h5xx_async_writer
+#include <boost/test/unit_test.hpp>
+
+#include <h5xx/h5xx.hpp>
+#include <h5xx/async_writer.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <cmath>
+#include <unistd.h>
+
+#include <test/ctest_full_output.hpp>
+
+BOOST_GLOBAL_FIXTURE( ctest_full_output );
+
+BOOST_AUTO_TEST_CASE( h5xx_async_writer )
+{
+    // store H5File object in shared_ptr to destroy it before re-opening the file
+    char const filename[] = "test_h5xx_async_writer.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    BOOST_CHECK_THROW(h5xx::async_writer(0), h5xx::error);
+
+    typedef boost::array<double, 3> array_type;
+    typedef boost::multi_array<int, 2> multi_array2;
+    multi_array2 multi_array_value(boost::extents[3][4]);
+    std::vector<array_type> array_vector_value(100);
+
+    H5::DataSet int_dataset = h5xx::create_chunked_dataset<int>(group, "int");
+    H5::DataSet array_dataset = h5xx::create_chunked_dataset<array_type>(group, "array");
+    H5::DataSet multi_array_dataset
+        = h5xx::create_chunked_dataset<multi_array2>(group, "multi_array", multi_array_value.shape());
+    H5::DataSet array_vector_dataset
+        = h5xx::create_chunked_dataset<std::vector<array_type> >(group, "array_vector", array_vector_value.size());
+    H5::DataSet fixed_dataset = h5xx::create_chunked_dataset<int>(group, "fixed", 2);
+
+    //
+    // stage records of various types, the source data may be modified right
+    // after submission
+    //
+    {
+        h5xx::async_writer writer(3);
+        BOOST_CHECK(writer.buffers() == 3);
+        for (int i = 0; i < 100; ++i) {
+            writer.write(int_dataset, i);
+            array_type array_value = {{ double(i), std::sqrt(double(i)), -double(i) }};
+            writer.write(array_dataset, array_value);
+            std::fill(multi_array_value.data(), multi_array_value.data() + multi_array_value.num_elements(), i);
+            writer.write(multi_array_dataset, multi_array_value);
+            array_vector_value[i] = array_value;
+            writer.write(array_vector_dataset, array_vector_value);
+        }
+        writer.write(int_dataset, -1, 0);  // overwrite entry #0
+        writer.flush();
+        BOOST_CHECK(h5xx::elements(int_dataset) == 100);
+        BOOST_CHECK(h5xx::elements(array_vector_dataset) == 100 * 100 * 3);
+
+        // errors are reported in the calling thread, subsequent records are discarded
+        writer.write(fixed_dataset, 1, 1);
+        writer.write(fixed_dataset, 2);
+        writer.write(int_dataset, 100);
+        BOOST_CHECK_THROW(writer.wait(), h5xx::error);
+        BOOST_CHECK_NO_THROW(writer.wait());
+
+        // the writer remains usable afterwards
+        writer.write(int_dataset, 100);
+        writer.wait();
+        BOOST_CHECK(h5xx::elements(int_dataset) == 101);
+
+        // the writer holds its own reference to the dataset until the next
+        // flush, the caller's dataset may be closed if no writes are pending
+        h5xx::create_chunked_dataset<int>(group, "temporary");
+        hid_t temporary_id;
+        {
+            H5::DataSet temporary = group.openDataSet("temporary");
+            temporary_id = temporary.getId();
+            for (int i = 0; i < 10; ++i) {
+                writer.write(temporary, i);
+            }
+            writer.wait();
+        }
+        BOOST_CHECK(H5Iis_valid(temporary_id) > 0);
+        writer.flush();
+        BOOST_CHECK(H5Iis_valid(temporary_id) == 0);
+        BOOST_CHECK(h5xx::elements(group.openDataSet("temporary")) == 10);
+
+        // pending records are written by the destructor
+        writer.write(int_dataset, 101);
+    }
+
+    // re-open file
+    file.reset(new H5::H5File(filename, H5F_ACC_RDONLY));
+    group = h5xx::open_group(*file, "/");
+
+    //
+    // read datasets
+    //
+
+    std::vector<int> int_vector;
+    h5xx::read_chunked_dataset(group.openDataSet("int"), int_vector, 0, 102);
+    BOOST_CHECK(int_vector[0] == -1);
+    for (int i = 1; i < 102; ++i) {
+        BOOST_CHECK(int_vector[i] == i);
+    }
+
+    std::vector<array_type> array_vector;
+    h5xx::read_chunked_dataset(group.openDataSet("array"), array_vector, 0, 100);
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK(array_vector[i][1] == std::sqrt(double(i)));
+    }
+
+    boost::multi_array<int, 3> multi_array3;
+    h5xx::read_chunked_dataset(group.openDataSet("multi_array"), multi_array3, 0, 100);
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK(multi_array3[i][2][3] == i);
+    }
+
+    h5xx::read_chunked_dataset(group.openDataSet("array_vector"), array_vector, 99);
+    BOOST_CHECK(array_vector == array_vector_value);
+    h5xx::read_chunked_dataset(group.openDataSet("array_vector"), array_vector, 0);
+    BOOST_CHECK(array_vector[0][2] == 0);
+    BOOST_CHECK(array_vector[1][2] == 0);
+
+    int fixed_value;
+    h5xx::read_chunked_dataset(group.openDataSet("fixed"), fixed_value, 1);
+    BOOST_CHECK(fixed_value == 1);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
@@ -29,7 +29,7 @@
 
 #include <test/ctest_full_output.hpp>
 
-BOOST_GLOBAL_FIXTURE( ctest_full_output )
+BOOST_GLOBAL_FIXTURE( ctest_full_output );
 
 BOOST_AUTO_TEST_CASE( h5xx_attribute )
 {
@@ -168,3 +168,202 @@ BOOST_AUTO_TEST_CASE( h5xx_attribute )
     unlink(filename);
 #endif
 }
+
+BOOST_AUTO_TEST_CASE( h5xx_attribute_batch )
+{
+    char const filename[] = "test_h5xx_attribute_batch.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    h5xx::write_attribute(group, "step", 1.5);    // wrong type
+    h5xx::write_attribute(group, "time", 0.);
+    h5xx::write_attribute(group, "unrelated", 42);
+
+    typedef boost::array<double, 3> array_type;
+    array_type box = {{ 10, 20, 30 }};
+    std::vector<int> ids(5, 7);
+    typedef boost::multi_array<int, 2> multi_array2;
+    multi_array2 matrix(boost::extents[2][3]);
+    matrix[1][2] = 5;
+    std::vector<std::string> names;
+    names.push_back("A");
+    names.push_back("ABC");
+
+    h5xx::attribute_batch batch;
+    batch.add("step", 10)
+         .add("time", 0.)
+         .add("box", box)
+         .add("ids", ids)
+         .add("matrix", matrix)
+         .add("name", "checkpoint")
+         .add("names", names)
+         .add("version", std::string("1.0"));
+    BOOST_CHECK(batch.size() == 8);
+    batch.write(group);
+    BOOST_CHECK(batch.created() == 7);   // including the recreated "step"
+    BOOST_CHECK(batch.updated() == 0);
+    BOOST_CHECK(batch.skipped() == 1);   // "time"
+
+    BOOST_CHECK(h5xx::read_attribute<int>(group, "step") == 10);
+    BOOST_CHECK(h5xx::read_attribute<double>(group, "time") == 0);
+    BOOST_CHECK(h5xx::read_attribute<array_type>(group, "box") == box);
+    BOOST_CHECK(h5xx::read_attribute<std::vector<int> >(group, "ids") == ids);
+    BOOST_CHECK(h5xx::read_attribute<multi_array2>(group, "matrix") == matrix);
+    BOOST_CHECK(h5xx::read_attribute<std::string>(group, "name") == "checkpoint");
+    BOOST_CHECK(h5xx::read_attribute<std::vector<std::string> >(group, "names") == names);
+    BOOST_CHECK(h5xx::read_attribute<std::string>(group, "version") == "1.0");
+    BOOST_CHECK(h5xx::read_attribute<int>(group, "unrelated") == 42);
+
+    // next checkpoint: update changed values in place
+    box[0] = 11;
+    ids.push_back(8);
+    batch.add("step", 20).add("time", 1.).add("box", box).add("ids", ids).add("name", "checkpoint!");
+    BOOST_CHECK(batch.size() == 8);
+    batch.write(group);
+    BOOST_CHECK(batch.created() == 2);   // "ids" and "name" of different size
+    BOOST_CHECK(batch.updated() == 3);
+    BOOST_CHECK(batch.skipped() == 3);
+    BOOST_CHECK(h5xx::read_attribute<int>(group, "step") == 20);
+    BOOST_CHECK(h5xx::read_attribute<double>(group, "time") == 1);
+    BOOST_CHECK(h5xx::read_attribute<array_type>(group, "box") == box);
+    BOOST_CHECK(h5xx::read_attribute<std::vector<int> >(group, "ids") == ids);
+    BOOST_CHECK(h5xx::read_attribute<std::string>(group, "name") == "checkpoint!");
+
+    // attributes of a dataset
+    H5::DataSet dataset = h5xx::create_dataset<double>(group, "dataset");
+    batch.write(dataset);
+    BOOST_CHECK(batch.created() == 8);
+    BOOST_CHECK(h5xx::read_attribute<int>(dataset, "step") == 20);
+
+    batch.clear();
+    BOOST_CHECK(batch.size() == 0);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_read_attributes )
+{
+    char const filename[] = "test_h5xx_read_attributes.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    typedef boost::array<float, 3> array_type;
+    typedef boost::multi_array<int, 2> multi_array2;
+    array_type box = {{ 1, 2, 3 }};
+    multi_array2 matrix(boost::extents[2][3]);
+    matrix[1][2] = 5;
+    std::vector<std::string> names;
+    names.push_back("A");
+    names.push_back("ABC");
+
+    h5xx::write_attribute(group, "int", 1);
+    h5xx::write_attribute(group, "unsigned long long", 2ULL);
+    h5xx::write_attribute(group, "double", 0.5);
+    h5xx::write_attribute(group, "bool", true);
+    h5xx::write_attribute(group, "string", std::string("abc"));
+    h5xx::write_attribute(group, "array", box);
+    h5xx::write_attribute(group, "multi_array", matrix);
+    h5xx::write_attribute(group, "names", names);
+
+    h5xx::attribute_map attributes = h5xx::read_attributes(group);
+    BOOST_CHECK(attributes.size() == 8);
+    BOOST_CHECK(boost::any_cast<int>(attributes["int"]) == 1);
+    // the first matching native type is chosen, which may be unsigned long
+    unsigned long long const* ullong_value = boost::any_cast<unsigned long long>(&attributes["unsigned long long"]);
+    unsigned long const* ulong_value = boost::any_cast<unsigned long>(&attributes["unsigned long long"]);
+    BOOST_CHECK((ullong_value && *ullong_value == 2) || (ulong_value && *ulong_value == 2));
+    BOOST_CHECK(boost::any_cast<double>(attributes["double"]) == 0.5);
+    BOOST_CHECK(boost::any_cast<char>(attributes["bool"]) == 1);
+    BOOST_CHECK(boost::any_cast<std::string>(attributes["string"]) == "abc");
+    std::vector<float> box_ = boost::any_cast<std::vector<float> >(attributes["array"]);
+    BOOST_CHECK(std::equal(box_.begin(), box_.end(), box.begin()) && box_.size() == 3);
+    BOOST_CHECK(boost::any_cast<multi_array2>(attributes["multi_array"]) == matrix);
+    BOOST_CHECK(boost::any_cast<std::vector<std::string> >(attributes["names"]) == names);
+
+    // attributes of a dataset, omit unsupported types
+    H5::DataSet dataset = h5xx::create_dataset<double>(group, "dataset");
+    BOOST_CHECK(h5xx::read_attributes(dataset).empty());
+    h5xx::write_attribute(dataset, "int", 1);
+    hid_t type = H5Tcreate(H5T_COMPOUND, sizeof(int));
+    H5Tinsert(type, "x", 0, H5T_NATIVE_INT);
+    hid_t space = H5Screate(H5S_SCALAR);
+    H5Aclose(H5Acreate2(dataset.getId(), "compound", type, space, H5P_DEFAULT, H5P_DEFAULT));
+    H5Sclose(space);
+    H5Tclose(type);
+    attributes = h5xx::read_attributes(dataset);
+    BOOST_CHECK(attributes.size() == 1 && attributes.count("int") == 1);
+
+    // variable-length strings are released by the HDF5 library
+    char const* vlen_names[] = { "A", "ABC" };
+    hsize_t nvlen = 2;
+    type = H5Tcopy(H5T_C_S1);
+    H5Tset_size(type, H5T_VARIABLE);
+    space = H5Screate_simple(1, &nvlen, NULL);
+    hid_t attr = H5Acreate2(dataset.getId(), "vlen", type, space, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite(attr, type, vlen_names);
+    H5Aclose(attr);
+    H5Sclose(space);
+    H5Tclose(type);
+    attributes = h5xx::read_attributes(dataset);
+    BOOST_CHECK(boost::any_cast<std::vector<std::string> >(attributes["vlen"]) == names);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+static herr_t count_errors(hid_t, void* count)
+{
+    ++*static_cast<int*>(count);
+    return 0;
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_attribute_errors )
+{
+    char const filename[] = "test_h5xx_attribute_errors.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // creating, updating and recreating attributes does not raise errors in the HDF5 library
+    H5E_auto2_t func;
+    void* client_data;
+    H5Eget_auto2(H5E_DEFAULT, &func, &client_data);
+    int errors = 0;
+    H5Eset_auto2(H5E_DEFAULT, &count_errors, &errors);
+
+    typedef boost::array<int, 2> array_type;
+    array_type array_value = {{ 1, 2 }};
+    boost::multi_array<int, 2> multi_array_value(boost::extents[2][2]);
+    for (int i = 0; i < 2; ++i) {
+        h5xx::write_attribute(group, "scalar", i);
+        h5xx::write_attribute(group, "scalar", 0.5 * i);
+        h5xx::write_attribute(group, "string", std::string("abc"));
+        h5xx::write_attribute(group, "char []", "abc");
+        h5xx::write_attribute(group, "array", array_value);
+        h5xx::write_attribute(group, "multi_array", multi_array_value);
+        h5xx::write_attribute(group, "vector", std::vector<int>(i + 1));
+    }
+    BOOST_CHECK(h5xx::read_attribute<double>(group, "scalar") == 0.5);
+    BOOST_CHECK(h5xx::read_attribute<std::vector<int> >(group, "vector").size() == 2);
+
+    // missing attributes are real errors
+    BOOST_CHECK_THROW(h5xx::read_attribute<int>(group, "missing"), H5::AttributeIException);
+    BOOST_CHECK_THROW(h5xx::read_attribute<std::string>(group, "missing"), H5::AttributeIException);
+    BOOST_CHECK_THROW(h5xx::read_attribute<array_type>(group, "missing"), H5::AttributeIException);
+    BOOST_CHECK(h5xx::read_attribute_if_exists<int>(group, "missing").empty());
+    BOOST_CHECK(errors == 0);
+
+    H5Eset_auto2(H5E_DEFAULT, func, client_data);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
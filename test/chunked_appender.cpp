@@ -0,0 +1,263 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE h5xx_chunked_appender
+#include <boost/test/unit_test.hpp>
+
+#include <h5xx/h5xx.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <cmath>
+#include <unistd.h>
+
+#include <test/ctest_full_output.hpp>
+
+BOOST_GLOBAL_FIXTURE( ctest_full_output );
+
+BOOST_AUTO_TEST_CASE( h5xx_chunked_appender )
+{
+    // store H5File object in shared_ptr to destroy it before re-opening the file
+    char const filename[] = "test_h5xx_chunked_appender.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    //
+    // append records in batches
+    //
+
+    // scalar type, the last incomplete batch is written upon flush()
+    H5::DataSet uint_dataset = h5xx::create_chunked_dataset<uint64_t>(group, "uint");
+    {
+        h5xx::chunked_appender<uint64_t> appender(uint_dataset, 4);
+        BOOST_CHECK(appender.capacity() == 4);
+        for (uint64_t i = 0; i < 10; ++i) {
+            appender.push_back(i * i);
+        }
+        BOOST_CHECK(appender.size() == 2);
+        BOOST_CHECK(h5xx::elements(uint_dataset) == 8);
+        appender.flush();
+        BOOST_CHECK(appender.size() == 0);
+        BOOST_CHECK(h5xx::elements(uint_dataset) == 10);
+    }
+
+    // array type, remaining records are written by the destructor
+    typedef boost::array<double, 3> array_type;
+    H5::DataSet array_dataset = h5xx::create_chunked_dataset<array_type>(group, "array");
+    {
+        h5xx::chunked_appender<array_type> appender(array_dataset, 3);
+        for (unsigned i = 0; i < 5; ++i) {
+            array_type value = {{ double(i), std::sqrt(double(i)), -double(i) }};
+            appender.push_back(value);
+        }
+    }
+    BOOST_CHECK(h5xx::elements(array_dataset) == 5 * 3);
+
+    // multi-array type
+    typedef boost::multi_array<int, 2> multi_array2;
+    multi_array2 multi_array_value(boost::extents[3][4]);
+    H5::DataSet multi_array_dataset
+        = h5xx::create_chunked_dataset<multi_array2>(group, "multi_array", multi_array_value.shape());
+    {
+        h5xx::chunked_appender<multi_array2> appender(multi_array_dataset, 2);
+        for (int i = 0; i < 3; ++i) {
+            std::fill(multi_array_value.data(), multi_array_value.data() + multi_array_value.num_elements(), i);
+            appender.push_back(multi_array_value);
+        }
+        // record of wrong shape
+        multi_array2 wrong_shape(boost::extents[4][3]);
+        BOOST_CHECK_THROW(appender.push_back(wrong_shape), std::runtime_error);
+        appender.flush();
+    }
+    BOOST_CHECK(h5xx::elements(multi_array_dataset) == 3 * 3 * 4);
+
+    // vector of scalars, mixed with unbuffered writes
+    std::vector<int> int_vector_value(5);
+    H5::DataSet int_vector_dataset
+        = h5xx::create_chunked_dataset<std::vector<int> >(group, "int_vector", int_vector_value.size());
+    h5xx::write_chunked_dataset(int_vector_dataset, int_vector_value);
+    {
+        h5xx::chunked_appender<std::vector<int> > appender(int_vector_dataset, 8);
+        for (int i = 1; i < 4; ++i) {
+            std::fill(int_vector_value.begin(), int_vector_value.end(), i);
+            appender.push_back(int_vector_value);
+        }
+        // vector of wrong size
+        BOOST_CHECK_THROW(appender.push_back(std::vector<int>(3)), std::runtime_error);
+        appender.flush();
+    }
+    BOOST_CHECK(h5xx::elements(int_vector_dataset) == 4 * 5);
+
+    // vector of arrays
+    std::vector<array_type> array_vector_value(2);
+    H5::DataSet array_vector_dataset
+        = h5xx::create_chunked_dataset<std::vector<array_type> >(group, "array_vector", array_vector_value.size());
+    {
+        h5xx::chunked_appender<std::vector<array_type> > appender(array_vector_dataset, 1);
+        for (unsigned i = 0; i < 2; ++i) {
+            array_vector_value[0].assign(i);
+            array_vector_value[1].assign(-double(i));
+            appender.push_back(array_vector_value);
+        }
+        BOOST_CHECK(appender.size() == 0);
+    }
+
+    // fixed-size dataset cannot be extended
+    H5::DataSet fixed_dataset = h5xx::create_chunked_dataset<int>(group, "fixed", 2);
+    {
+        h5xx::chunked_appender<int> appender(fixed_dataset, 4);
+        appender.push_back(1);
+        BOOST_CHECK_THROW(appender.flush(), std::runtime_error);
+    }
+
+    // invalid capacity and dataset of wrong rank
+    BOOST_CHECK_THROW(h5xx::chunked_appender<int>(uint_dataset, 0), h5xx::error);
+    BOOST_CHECK_THROW(h5xx::chunked_appender<array_type>(uint_dataset, 1), std::runtime_error);
+
+    // re-open file
+    file.reset(new H5::H5File(filename, H5F_ACC_RDONLY));
+    group = h5xx::open_group(*file, "/");
+
+    //
+    // read datasets
+    //
+
+    uint_dataset = group.openDataSet("uint");
+    for (unsigned i = 0; i < 10; ++i) {
+        uint64_t uint_value;
+        h5xx::read_chunked_dataset(uint_dataset, uint_value, i);
+        BOOST_CHECK(uint_value == i * i);
+    }
+
+    array_dataset = group.openDataSet("array");
+    for (unsigned i = 0; i < 5; ++i) {
+        array_type value;
+        h5xx::read_chunked_dataset(array_dataset, value, i);
+        BOOST_CHECK(value[0] == double(i));
+        BOOST_CHECK(value[1] == std::sqrt(double(i)));
+        BOOST_CHECK(value[2] == -double(i));
+    }
+
+    multi_array_dataset = group.openDataSet("multi_array");
+    for (int i = 0; i < 3; ++i) {
+        multi_array2 value;
+        h5xx::read_chunked_dataset(multi_array_dataset, value, i);
+        BOOST_CHECK(value.shape()[0] == 3 && value.shape()[1] == 4);
+        BOOST_CHECK(std::count(value.data(), value.data() + value.num_elements(), i) == 3 * 4);
+    }
+
+    int_vector_dataset = group.openDataSet("int_vector");
+    for (int i = 0; i < 4; ++i) {
+        std::vector<int> value;
+        h5xx::read_chunked_dataset(int_vector_dataset, value, i);
+        BOOST_CHECK(value.size() == 5);
+        BOOST_CHECK(std::count(value.begin(), value.end(), i) == 5);
+    }
+
+    array_vector_dataset = group.openDataSet("array_vector");
+    std::vector<array_type> array_vector_value_;
+    h5xx::read_chunked_dataset(array_vector_dataset, array_vector_value_, 1);
+    BOOST_CHECK(array_vector_value_.size() == 2);
+    BOOST_CHECK(array_vector_value_[0][2] == 1);
+    BOOST_CHECK(array_vector_value_[1][0] == -1);
+
+    BOOST_CHECK(h5xx::elements(group.openDataSet("fixed")) == 2);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_chunked_appender_growth )
+{
+    char const filename[] = "test_h5xx_chunked_appender_growth.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // growth policies
+    BOOST_CHECK(h5xx::extent_growth::exact()(4, 5, 16) == 5);
+    BOOST_CHECK(h5xx::extent_growth::geometric()(4, 5, 16) == 8);
+    BOOST_CHECK(h5xx::extent_growth::geometric(1.5)(0, 5, 16) == 6);
+    BOOST_CHECK(h5xx::extent_growth::chunks()(4, 5, 16) == 16);
+    BOOST_CHECK(h5xx::extent_growth::chunks(2)(32, 33, 16) == 64);
+    BOOST_CHECK_THROW(h5xx::extent_growth::geometric(1), h5xx::error);
+    BOOST_CHECK_THROW(h5xx::extent_growth::chunks(0), h5xx::error);
+
+    // geometric growth, extent is trimmed upon flush()
+    H5::DataSet int_dataset = h5xx::create_chunked_dataset<int>(group, "int");
+    {
+        h5xx::chunked_appender<int> appender(int_dataset, 2, h5xx::extent_growth::geometric());
+        for (int i = 0; i < 5; ++i) {
+            appender.push_back(i);
+        }
+        BOOST_CHECK(appender.length() == 4);
+        BOOST_CHECK(appender.extent() == 4);
+        appender.push_back(5);
+        BOOST_CHECK(appender.length() == 6);
+        BOOST_CHECK(appender.extent() == 8);
+        BOOST_CHECK(h5xx::elements(int_dataset) == 8);
+        appender.push_back(6);
+        appender.flush();
+        BOOST_CHECK(appender.length() == 7);
+        BOOST_CHECK(appender.extent() == 7);
+        BOOST_CHECK(h5xx::elements(int_dataset) == 7);
+        appender.push_back(7);
+    }
+    BOOST_CHECK(h5xx::elements(int_dataset) == 8);
+
+    // chunk-wise growth continues an existing dataset
+    typedef boost::array<double, 3> array_type;
+    array_type array_value = {{ 1, 2, 3 }};
+    H5::DataSet array_dataset = h5xx::create_chunked_dataset<array_type>(group, "array");
+    h5xx::write_chunked_dataset(array_dataset, array_value);
+    {
+        h5xx::chunked_appender<array_type> appender(array_dataset, 1, h5xx::extent_growth::chunks());
+        BOOST_CHECK(appender.length() == 1);
+        appender.push_back(array_value);
+        BOOST_CHECK(appender.extent() > 2);
+        BOOST_CHECK(appender.extent() % 2 == 0);
+    }
+    BOOST_CHECK(h5xx::elements(array_dataset) == 2 * 3);
+
+    // growth is limited by the maximum extent
+    H5::DataSet fixed_dataset = h5xx::create_chunked_dataset<int>(group, "fixed", 3);
+    BOOST_CHECK_THROW(
+        h5xx::chunked_appender<int>(fixed_dataset, 1, h5xx::extent_growth::geometric()).push_back(0)
+      , std::runtime_error
+    );
+
+    // re-open file
+    file.reset(new H5::H5File(filename, H5F_ACC_RDONLY));
+    group = h5xx::open_group(*file, "/");
+
+    int_dataset = group.openDataSet("int");
+    BOOST_CHECK(h5xx::elements(int_dataset) == 8);
+    for (int i = 0; i < 8; ++i) {
+        int value;
+        h5xx::read_chunked_dataset(int_dataset, value, i);
+        BOOST_CHECK(value == i);
+    }
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
@@ -28,7 +28,21 @@
 
 #include <test/ctest_full_output.hpp>
 
-BOOST_GLOBAL_FIXTURE( ctest_full_output )
+BOOST_GLOBAL_FIXTURE( ctest_full_output );
+
+namespace test {
+
+struct particle
+{
+    double position[3];
+    boost::array<float, 3> velocity;
+    int species;
+    char padding;
+};
+
+} // namespace test
+
+H5XX_COMPOUND_TYPE( test::particle, (position)(velocity)(species) )
 
 // BOOST_CHECK doesn't like more than one template parameter :-(
 // so we define these wrappers here
@@ -221,3 +235,503 @@ BOOST_AUTO_TEST_CASE( h5xx_chunked_dataset )
     unlink(filename);
 #endif
 }
+
+BOOST_AUTO_TEST_CASE( h5xx_chunked_dataset_handle )
+{
+    char const filename[] = "test_h5xx_chunked_dataset_handle.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // scalar type
+    h5xx::chunked_dataset<int> int_dataset(h5xx::create_chunked_dataset<int>(group, "int"));
+    BOOST_CHECK(int_dataset.size() == 0);
+    for (int i = 0; i < 10; ++i) {
+        int_dataset.write(i);
+    }
+    int_dataset.write(-1, 3);                                  // overwrite entry #3
+    BOOST_CHECK(int_dataset.size() == 10);
+    BOOST_CHECK(h5xx::elements(int_dataset.dataset()) == 10);
+
+    int int_value;
+    BOOST_CHECK(int_dataset.read(int_value, 2) == 2);
+    BOOST_CHECK(int_value == 2);
+    BOOST_CHECK(int_dataset.read(int_value, -7) == 3);
+    BOOST_CHECK(int_value == -1);
+    BOOST_CHECK_THROW(int_dataset.read(int_value, 10), std::runtime_error);
+    BOOST_CHECK_THROW(int_dataset.write(0, 10), std::runtime_error);
+    BOOST_CHECK(int_dataset.size() == 10);
+
+    // handle sees appends through the free functions only after refresh()
+    h5xx::write_chunked_dataset(int_dataset.dataset(), 10);
+    BOOST_CHECK(int_dataset.size() == 10);
+    int_dataset.refresh();
+    BOOST_CHECK(int_dataset.size() == 11);
+    BOOST_CHECK(int_dataset.read(int_value, -1) == 10);
+    BOOST_CHECK(int_value == 10);
+
+    // array type, read as float
+    typedef boost::array<double, 3> array_type;
+    array_type array_value = {{ 1, std::sqrt(2.), 2 }};
+    h5xx::chunked_dataset<array_type> array_dataset(h5xx::create_chunked_dataset<array_type>(group, "array"));
+    array_dataset.write(array_value);
+    array_dataset.write(array_value);
+    h5xx::chunked_dataset<boost::array<float, 3> > float_array_dataset(array_dataset.dataset());
+    boost::array<float, 3> float_array_value;
+    float_array_dataset.read(float_array_value, 1);
+    BOOST_CHECK(float_array_value[1] == static_cast<float>(array_value[1]));
+
+    // array of wrong size
+    typedef boost::array<double, 2> array2_type;
+    BOOST_CHECK_THROW(h5xx::chunked_dataset<array2_type>(array_dataset.dataset()), std::runtime_error);
+    BOOST_CHECK_THROW(h5xx::chunked_dataset<array_type>(int_dataset.dataset()), std::runtime_error);
+
+    // multi-array type, result is reshaped
+    typedef boost::multi_array<int, 2> multi_array2;
+    multi_array2 multi_array_value(boost::extents[3][4]);
+    for (unsigned i = 0; i < multi_array_value.num_elements(); ++i) {
+        multi_array_value.data()[i] = i;
+    }
+    h5xx::chunked_dataset<multi_array2> multi_array_dataset(
+        h5xx::create_chunked_dataset<multi_array2>(group, "multi_array", multi_array_value.shape())
+    );
+    multi_array_dataset.write(multi_array_value);
+    BOOST_CHECK(multi_array_dataset.shape()[0] == 3 && multi_array_dataset.shape()[1] == 4);
+    multi_array2 multi_array_value_;
+    multi_array_dataset.read(multi_array_value_, 0);
+    BOOST_CHECK(multi_array_value_ == multi_array_value);
+    BOOST_CHECK_THROW(multi_array_dataset.write(multi_array2(boost::extents[4][3])), std::runtime_error);
+
+    // vector of arrays
+    std::vector<array_type> array_vector_value(5, array_value);
+    h5xx::chunked_dataset<std::vector<array_type> > array_vector_dataset(
+        h5xx::create_chunked_dataset<std::vector<array_type> >(group, "array_vector", array_vector_value.size())
+    );
+    array_vector_dataset.write(array_vector_value);
+    std::vector<array_type> array_vector_value_;
+    array_vector_dataset.read(array_vector_value_, 0);
+    BOOST_CHECK(array_vector_value_ == array_vector_value);
+
+    // fixed-size dataset cannot be extended
+    h5xx::chunked_dataset<int> fixed_dataset(h5xx::create_chunked_dataset<int>(group, "fixed", 2));
+    fixed_dataset.write(1, 1);
+    BOOST_CHECK_THROW(fixed_dataset.write(2), std::runtime_error);
+    BOOST_CHECK(fixed_dataset.size() == 2);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_chunked_dataset_range )
+{
+    char const filename[] = "test_h5xx_chunked_dataset_range.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // write 10 records of each type
+    typedef boost::array<double, 3> array_type;
+    typedef boost::multi_array<int, 2> multi_array2;
+    H5::DataSet int_dataset = h5xx::create_chunked_dataset<int>(group, "int");
+    H5::DataSet array_dataset = h5xx::create_chunked_dataset<array_type>(group, "array");
+    multi_array2 multi_array_value(boost::extents[3][4]);
+    H5::DataSet multi_array_dataset
+        = h5xx::create_chunked_dataset<multi_array2>(group, "multi_array", multi_array_value.shape());
+    for (int i = 0; i < 10; ++i) {
+        h5xx::write_chunked_dataset(int_dataset, i);
+        array_type array_value = {{ double(i), 2. * i, 3. * i }};
+        h5xx::write_chunked_dataset(array_dataset, array_value);
+        for (unsigned j = 0; j < multi_array_value.num_elements(); ++j) {
+            multi_array_value.data()[j] = 100 * i + j;
+        }
+        h5xx::write_chunked_dataset(multi_array_dataset, multi_array_value);
+    }
+
+    // scalar records into vector
+    std::vector<int> int_vector;
+    h5xx::read_chunked_dataset(int_dataset, int_vector, 2, 5);
+    BOOST_CHECK(int_vector.size() == 5);
+    for (int i = 0; i < 5; ++i) {
+        BOOST_CHECK(int_vector[i] == i + 2);
+    }
+    h5xx::read_chunked_dataset(int_dataset, int_vector, 10, 0);
+    BOOST_CHECK(int_vector.empty());
+    BOOST_CHECK_THROW(h5xx::read_chunked_dataset(int_dataset, int_vector, 8, 3), std::runtime_error);
+    BOOST_CHECK_THROW(h5xx::read_chunked_dataset(int_dataset, int_vector, 11, 0), std::runtime_error);
+
+    // array records into vector of arrays, converted to float
+    std::vector<boost::array<float, 3> > float_array_vector;
+    h5xx::read_chunked_dataset(array_dataset, float_array_vector, 0, 10);
+    BOOST_CHECK(float_array_vector.size() == 10);
+    BOOST_CHECK(float_array_vector[7][2] == 21);
+    BOOST_CHECK_THROW(h5xx::read_chunked_dataset(int_dataset, float_array_vector, 0, 1), std::runtime_error);
+
+    // multi-array records into multi-array of rank 3
+    boost::multi_array<int, 3> multi_array3;
+    h5xx::read_chunked_dataset(multi_array_dataset, multi_array3, 7, 3);
+    BOOST_CHECK(multi_array3.shape()[0] == 3);
+    BOOST_CHECK(multi_array3.shape()[1] == 3);
+    BOOST_CHECK(multi_array3.shape()[2] == 4);
+    BOOST_CHECK(multi_array3[0][0][0] == 700);
+    BOOST_CHECK(multi_array3[2][2][3] == 911);
+
+    // scalar records into multi-array of rank 1
+    boost::multi_array<int, 1> multi_array1;
+    h5xx::read_chunked_dataset(int_dataset, multi_array1, 0, 10);
+    BOOST_CHECK(multi_array1.shape()[0] == 10);
+    BOOST_CHECK(multi_array1[9] == 9);
+    BOOST_CHECK_THROW(h5xx::read_chunked_dataset(array_dataset, multi_array1, 0, 1), std::runtime_error);
+
+    // contiguous buffer
+    std::vector<double> buffer(4 * 3);
+    h5xx::read_chunked_dataset(array_dataset, &*buffer.begin(), 5, 4);
+    BOOST_CHECK(buffer[0] == 5);
+    BOOST_CHECK(buffer[11] == 24);
+
+    // strided reads
+    h5xx::read_chunked_dataset(int_dataset, int_vector, 0, 4, 3);
+    BOOST_CHECK(int_vector.size() == 4);
+    BOOST_CHECK(int_vector[0] == 0 && int_vector[1] == 3 && int_vector[2] == 6 && int_vector[3] == 9);
+    BOOST_CHECK_THROW(h5xx::read_chunked_dataset(int_dataset, int_vector, 1, 4, 3), std::runtime_error);
+    BOOST_CHECK_THROW(h5xx::read_chunked_dataset(int_dataset, int_vector, 1, 2, 0), std::runtime_error);
+    h5xx::read_chunked_dataset(multi_array_dataset, multi_array3, 0, 2, 9);
+    BOOST_CHECK(multi_array3.shape()[0] == 2);
+    BOOST_CHECK(multi_array3[1][0][1] == 901);
+
+    // chunk-wise strided reads, the chunks hold more than 10 records
+    // (see CHUNK_MIN_SIZE), shrink them for this test
+    std::vector<int> int_vector2;
+    H5::DSetCreatPropList cparms;
+    hsize_t dim = 0, max_dim = H5S_UNLIMITED, chunk_dim = 4;
+    cparms.setChunk(1, &chunk_dim);
+    H5::DataSet small_chunks_dataset = group.createDataSet(
+        "small_chunks", H5::PredType::NATIVE_INT, H5::DataSpace(1, &dim, &max_dim), cparms
+    );
+    for (int i = 0; i < 30; ++i) {
+        h5xx::write_chunked_dataset(small_chunks_dataset, i);
+    }
+    for (hsize_t stride = 1; stride < 10; ++stride) {
+        hsize_t count = (30 - 2 - 1) / stride + 1;
+        h5xx::read_chunked_dataset(small_chunks_dataset, int_vector, 2, count, stride, h5xx::read_by_chunk);
+        h5xx::read_chunked_dataset(small_chunks_dataset, int_vector2, 2, count, stride);
+        BOOST_CHECK(int_vector.size() == count);
+        BOOST_CHECK(int_vector == int_vector2);
+        BOOST_CHECK(int_vector.back() == int(2 + (count - 1) * stride));
+    }
+    h5xx::read_chunked_dataset(multi_array_dataset, multi_array3, 1, 3, 4, h5xx::read_by_chunk);
+    BOOST_CHECK(multi_array3.shape()[0] == 3);
+    BOOST_CHECK(multi_array3[2][2][3] == 911);
+    BOOST_CHECK_THROW(
+        h5xx::read_chunked_dataset(small_chunks_dataset, int_vector, 29, 2, 1, h5xx::read_by_chunk)
+      , std::runtime_error
+    );
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_chunked_dataset_chunk_policy )
+{
+    char const filename[] = "test_h5xx_chunked_dataset_chunk_policy.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    typedef boost::array<double, 3> array_type;
+    typedef std::vector<array_type> array_vector_type;
+    std::vector<hsize_t> chunk;
+
+    // default policy: at least 8 KiB per chunk
+    chunk = h5xx::chunk_shape(h5xx::create_chunked_dataset<int>(group, "default"));
+    BOOST_CHECK(chunk.size() == 1 && chunk[0] == 2048);
+    chunk = h5xx::chunk_shape(h5xx::create_chunked_dataset<array_type>(group, "default_array"));
+    BOOST_CHECK(chunk.size() == 2 && chunk[0] == 512 && chunk[1] == 3);
+
+    // target chunk size in bytes
+    chunk = h5xx::chunk_shape(h5xx::create_chunked_dataset<array_vector_type>(
+        group, "bytes", 1000, H5S_UNLIMITED, h5xx::chunk_policy::bytes(1 << 20)
+    ));
+    BOOST_CHECK(chunk.size() == 3);
+    BOOST_CHECK(chunk[0] == (1 << 20) / (1000 * 3 * sizeof(double)));
+    BOOST_CHECK(chunk[1] == 1000 && chunk[2] == 3);
+    // at least one record per chunk
+    chunk = h5xx::chunk_shape(h5xx::create_chunked_dataset<array_vector_type>(
+        group, "bytes_small", 1000, H5S_UNLIMITED, h5xx::chunk_policy::bytes(100)
+    ));
+    BOOST_CHECK(chunk[0] == 1);
+
+    // fixed number of records, limited by maximum extent
+    chunk = h5xx::chunk_shape(h5xx::create_chunked_dataset<float>(
+        group, "records", H5S_UNLIMITED, h5xx::chunk_policy::records(100)
+    ));
+    BOOST_CHECK(chunk[0] == 100);
+    chunk = h5xx::chunk_shape(h5xx::create_chunked_dataset<float>(
+        group, "records_fixed", 10, h5xx::chunk_policy::records(100)
+    ));
+    BOOST_CHECK(chunk[0] == 10);
+
+    // explicit chunk dimensions
+    std::vector<hsize_t> dims(3);
+    dims[0] = 4; dims[1] = 100; dims[2] = 3;
+    H5::DataSet dims_dataset = h5xx::create_chunked_dataset<array_vector_type>(
+        group, "dims", 1000, H5S_UNLIMITED, h5xx::chunk_policy::dims(dims)
+    );
+    BOOST_CHECK(h5xx::chunk_shape(dims_dataset) == dims);
+    array_vector_type array_vector(1000);
+    array_vector[999][2] = 42;
+    h5xx::write_chunked_dataset(dims_dataset, array_vector);
+    h5xx::read_chunked_dataset(dims_dataset, array_vector, 0);
+    BOOST_CHECK(array_vector[999][2] == 42);
+    BOOST_CHECK_THROW(h5xx::create_chunked_dataset<int>(
+        group, "dims_rank", H5S_UNLIMITED, h5xx::chunk_policy::dims(dims)
+    ), h5xx::error);
+    BOOST_CHECK_THROW(h5xx::chunk_policy::dims(std::vector<hsize_t>(2, 0)), h5xx::error);
+
+    // chunk cache of the file, 1 MiB by default
+    size_t nslots, nbytes;
+    double w0;
+    H5Pget_cache(file->getAccessPlist().getId(), NULL, &nslots, &nbytes, &w0);
+    chunk = h5xx::chunk_shape(h5xx::create_chunked_dataset<double>(
+        group, "cache", H5S_UNLIMITED, h5xx::chunk_policy::cache(4)
+    ));
+    BOOST_CHECK(chunk[0] == nbytes / 4 / sizeof(double));
+
+    // tiles of bounded size, also for large records
+    typedef boost::multi_array<double, 2> multi_array2;
+    multi_array2 multi_array_value(boost::extents[1000][1000]);
+    chunk = h5xx::chunk_shape(h5xx::create_chunked_dataset<multi_array2>(
+        group, "tiles", multi_array_value.shape(), H5S_UNLIMITED, h5xx::chunk_policy::tiles()
+    ));
+    BOOST_CHECK(chunk.size() == 3);
+    BOOST_CHECK(chunk[0] == 1 && chunk[1] == 125 && chunk[2] == 1000);
+    chunk = h5xx::chunk_shape(h5xx::create_chunked_dataset<double>(
+        group, "tiles_scalar", H5S_UNLIMITED, h5xx::chunk_policy::tiles(1000)
+    ));
+    BOOST_CHECK(chunk[0] == 125);
+    chunk = h5xx::chunk_shape(h5xx::create_chunked_dataset<double>(
+        group, "tiles_fixed", 1000, h5xx::chunk_policy::tiles(3000)
+    ));
+    BOOST_CHECK(chunk[0] == 334);
+
+    // invalid policies and non-chunked datasets
+    BOOST_CHECK_THROW(h5xx::chunk_policy::bytes(0), h5xx::error);
+    BOOST_CHECK_THROW(h5xx::chunk_policy::records(0), h5xx::error);
+    BOOST_CHECK_THROW(h5xx::chunk_policy::cache(0), h5xx::error);
+    BOOST_CHECK_THROW(h5xx::chunk_policy::tiles(0), h5xx::error);
+    hsize_t dim[1] = { 10 };
+    H5::DataSet contiguous = group.createDataSet("contiguous", H5::PredType::NATIVE_INT, H5::DataSpace(1, dim));
+    BOOST_CHECK_THROW(h5xx::chunk_shape(contiguous), h5xx::error);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_chunked_dataset_compound )
+{
+    char const filename[] = "test_h5xx_chunked_dataset_compound.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    std::vector<test::particle> particles(10);
+    H5::DataSet trajectory
+        = h5xx::create_chunked_dataset<std::vector<test::particle> >(group, "trajectory", particles.size());
+    H5::DataSet single = h5xx::create_chunked_dataset<test::particle>(group, "single");
+    for (int step = 0; step < 5; ++step) {
+        for (unsigned i = 0; i < particles.size(); ++i) {
+            std::fill(particles[i].position, particles[i].position + 3, step + 0.1 * i);
+            particles[i].velocity.assign(step);
+            particles[i].species = i;
+        }
+        h5xx::write_chunked_dataset(trajectory, particles);
+        h5xx::write_chunked_dataset(single, particles[step]);
+    }
+    h5xx::chunked_dataset<std::vector<test::particle> > handle(trajectory);
+    BOOST_CHECK(handle.size() == 5);
+
+    // re-open file
+    file.reset(new H5::H5File(filename, H5F_ACC_RDONLY));
+    group = h5xx::open_group(*file, "/");
+
+    trajectory = group.openDataSet("trajectory");
+    h5xx::read_chunked_dataset(trajectory, particles, 2);
+    BOOST_CHECK(particles.size() == 10);
+    BOOST_CHECK(particles[3].position[1] == 2 + 0.1 * 3);
+    BOOST_CHECK(particles[3].velocity[1] == 2);
+    BOOST_CHECK(particles[3].species == 3);
+
+    // range of records of a single struct each
+    std::vector<test::particle> records;
+    h5xx::read_chunked_dataset(group.openDataSet("single"), records, 0, 5);
+    for (int step = 0; step < 5; ++step) {
+        BOOST_CHECK(records[step].position[0] == step + 0.1 * step);
+        BOOST_CHECK(records[step].species == step);
+    }
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_chunked_dataset_storage )
+{
+    char const filename[] = "test_h5xx_chunked_dataset_storage.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // trajectory of positions in double precision, stored as float
+    typedef boost::array<double, 3> array_type;
+    typedef std::vector<array_type> array_vector_type;
+    array_vector_type positions(100);
+    H5::DataSet trajectory = h5xx::create_chunked_dataset<array_vector_type, float>(group, "trajectory", positions.size());
+    BOOST_CHECK(h5xx::has_type<float>(trajectory));
+    for (int step = 0; step < 10; ++step) {
+        for (unsigned i = 0; i < positions.size(); ++i) {
+            array_type r = {{ std::sqrt(double(i)), 1. / (step + 1), double(step) }};
+            positions[i] = r;
+        }
+        h5xx::write_chunked_dataset(trajectory, positions);
+    }
+
+    // scalar records stored in half precision, written through the handle
+    H5::DataSet energy = h5xx::create_chunked_dataset<double, h5xx::half>(group, "energy");
+    h5xx::chunked_dataset<double> handle(energy);
+    for (int step = 0; step < 10; ++step) {
+        handle.write(0.5 * step);
+    }
+    // ties are rounded to even, unlike by the HDF5 library
+    handle.write(2049.);
+    h5xx::write_chunked_dataset(energy, 2049.);
+
+    // multi_array records of floats stored in half precision
+    typedef boost::multi_array<float, 2> multi_array2;
+    multi_array2 multi_array_value(boost::extents[2][3]);
+    H5::DataSet multi_array_dataset
+        = h5xx::create_chunked_dataset<multi_array2, h5xx::half>(group, "multi_array", multi_array_value.shape());
+    std::fill(multi_array_value.data(), multi_array_value.data() + multi_array_value.num_elements(), 1.5f);
+    h5xx::write_chunked_dataset(multi_array_dataset, multi_array_value);
+
+    // the chunk size is determined by the storage type
+    BOOST_CHECK(h5xx::chunk_shape(h5xx::create_chunked_dataset<double, h5xx::half>(group, "chunk"))[0] == 4096);
+
+    // re-open file
+    file.reset(new H5::H5File(filename, H5F_ACC_RDONLY));
+    group = h5xx::open_group(*file, "/");
+
+    h5xx::read_chunked_dataset(group.openDataSet("trajectory"), positions, 3);
+    BOOST_CHECK(positions[10][0] == static_cast<float>(std::sqrt(10.)));
+    BOOST_CHECK(positions[10][1] == static_cast<float>(1. / 4));
+    BOOST_CHECK(positions[10][2] == 3);
+
+    std::vector<double> energies;
+    h5xx::read_chunked_dataset(group.openDataSet("energy"), energies, 0, 10);
+    for (int step = 0; step < 10; ++step) {
+        BOOST_CHECK(energies[step] == 0.5 * step);
+    }
+    h5xx::read_chunked_dataset(group.openDataSet("energy"), energies, 10, 2);
+    BOOST_CHECK(energies[0] == 2048);
+    BOOST_CHECK(energies[1] == 2048);
+
+    multi_array2 multi_array_value_;
+    h5xx::read_chunked_dataset(group.openDataSet("multi_array"), multi_array_value_, 0);
+    BOOST_CHECK(multi_array_value_ == multi_array_value);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_chunked_dataset_reuse )
+{
+    char const filename[] = "test_h5xx_chunked_dataset_reuse.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    typedef boost::array<double, 3> array_type;
+    std::vector<array_type> positions(1000);
+    hsize_t size = 0;
+    for (int i = 0; i < 5; ++i) {
+        H5::DataSet dataset = h5xx::create_chunked_dataset<std::vector<array_type> >(
+            group, "trajectory", positions.size(), H5S_UNLIMITED
+          , h5xx::chunk_policy(), h5xx::filter_pipeline().deflate(), h5xx::reuse_existing
+        );
+        // reused dataset is truncated
+        BOOST_CHECK(dataset.getSpace().getSimpleExtentNpoints() == 0);
+        h5xx::write_chunked_dataset(dataset, positions);
+        h5xx::write_chunked_dataset(dataset, positions);
+        file->flush(H5F_SCOPE_GLOBAL);
+        if (i == 1) {
+            size = file->getFileSize();
+        }
+    }
+    BOOST_CHECK(file->getFileSize() == size);
+
+    // a dataset of different chunk shape is replaced
+    H5::DataSet dataset = h5xx::create_chunked_dataset<std::vector<array_type> >(
+        group, "trajectory", positions.size(), H5S_UNLIMITED
+      , h5xx::chunk_policy::records(1), h5xx::filter_pipeline().deflate(), h5xx::reuse_existing
+    );
+    BOOST_CHECK(h5xx::chunk_shape(dataset)[0] == 1);
+
+    // datasets of fixed size are kept as they are
+    dataset = h5xx::create_chunked_dataset<double>(
+        group, "energy", 4, h5xx::chunk_policy(), h5xx::filter_pipeline(), h5xx::reuse_existing
+    );
+    h5xx::write_chunked_dataset(dataset, 1., 2);
+    dataset = h5xx::create_chunked_dataset<double>(
+        group, "energy", 4, h5xx::chunk_policy(), h5xx::filter_pipeline(), h5xx::reuse_existing
+    );
+    double energy;
+    h5xx::read_chunked_dataset(dataset, energy, 2);
+    BOOST_CHECK(energy == 1);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_chunked_dataset_multi_array_view )
+{
+    char const filename[] = "test_h5xx_chunked_dataset_multi_array_view.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // write every second column of a matrix as a record
+    typedef boost::multi_array<int, 2> multi_array2;
+    typedef multi_array2::index_range range;
+    multi_array2 array(boost::extents[10][8]);
+    for (unsigned i = 0; i < array.num_elements(); ++i) {
+        array.data()[i] = i;
+    }
+    multi_array2::const_array_view<2>::type view = array[boost::indices[range()][range(1, 8, 2)]];
+    multi_array2::size_type shape[2] = { 10, 4 };
+    H5::DataSet dataset = h5xx::create_chunked_dataset<multi_array2>(group, "view", shape);
+    h5xx::write_chunked_dataset(dataset, view);
+    h5xx::write_chunked_dataset(dataset, array[boost::indices[range(9, -1, -1)][range(0, 8, 2)]]);
+    h5xx::write_chunked_dataset(dataset, view, 0);
+    BOOST_CHECK(h5xx::elements(dataset) == 2 * 40);
+
+    multi_array2 value;
+    h5xx::read_chunked_dataset(dataset, value, 0);
+    BOOST_CHECK(value == view);
+    h5xx::read_chunked_dataset(dataset, value, 1);
+    BOOST_CHECK(value[0][0] == array[9][0]);
+    BOOST_CHECK(value[9][3] == array[0][6]);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
@@ -24,11 +24,26 @@
 
 #include <boost/shared_ptr.hpp>
 #include <cmath>
+#include <limits>
 #include <unistd.h>
 
 #include <test/ctest_full_output.hpp>
 
-BOOST_GLOBAL_FIXTURE( ctest_full_output )
+BOOST_GLOBAL_FIXTURE( ctest_full_output );
+
+namespace test {
+
+struct particle
+{
+    double position[3];
+    boost::array<float, 3> velocity;
+    int species;
+    char padding;
+};
+
+} // namespace test
+
+H5XX_COMPOUND_TYPE( test::particle, (position)(velocity)(species) )
 
 BOOST_AUTO_TEST_CASE( h5xx_dataset )
 {
@@ -193,3 +208,797 @@ BOOST_AUTO_TEST_CASE( h5xx_dataset )
     unlink(filename);
 #endif
 }
+
+/** return filters of dataset in order of application */
+static std::vector<H5Z_filter_t> filters(H5::DataSet const& dataset)
+{
+    H5::DSetCreatPropList cparms(dataset.getCreatePlist());
+    std::vector<H5Z_filter_t> result;
+    for (int i = 0; i < cparms.getNfilters(); ++i) {
+        unsigned int flags, config;
+        size_t nelmts = 0;
+        result.push_back(H5Pget_filter2(cparms.getId(), i, &flags, &nelmts, NULL, 0, NULL, &config));
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_dataset_filters )
+{
+    char const filename[] = "test_h5xx_dataset_filters.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    typedef boost::array<double, 3> array_type;
+    typedef std::vector<array_type> array_vector_type;
+    array_vector_type array_vector(1000);
+    for (unsigned i = 0; i < array_vector.size(); ++i) {
+        array_type value = {{ 0.5 * i, std::sqrt(double(i)), -double(i) }};
+        array_vector[i] = value;
+    }
+    std::vector<int> int_vector(1000);
+    for (unsigned i = 0; i < int_vector.size(); ++i) {
+        int_vector[i] = i % 100;
+    }
+
+    // default: GZIP compression
+    H5::DataSet dataset = h5xx::create_dataset<array_vector_type>(group, "default", array_vector.size());
+    BOOST_CHECK(filters(dataset) == std::vector<H5Z_filter_t>(1, H5Z_FILTER_DEFLATE));
+
+    // empty pipeline: contiguous layout
+    dataset = h5xx::create_dataset<array_vector_type>(group, "none", array_vector.size(), h5xx::filter_pipeline());
+    BOOST_CHECK(H5::DSetCreatPropList(dataset.getCreatePlist()).getLayout() == H5D_CONTIGUOUS);
+    h5xx::write_dataset(dataset, array_vector);
+
+    // filters are applied in the given order
+    dataset = h5xx::create_dataset<array_vector_type>(
+        group, "shuffle", array_vector.size(), h5xx::filter_pipeline().shuffle().deflate(9).fletcher32()
+    );
+    std::vector<H5Z_filter_t> expected;
+    expected.push_back(H5Z_FILTER_SHUFFLE);
+    expected.push_back(H5Z_FILTER_DEFLATE);
+    expected.push_back(H5Z_FILTER_FLETCHER32);
+    BOOST_CHECK(filters(dataset) == expected);
+    h5xx::write_dataset(dataset, array_vector);
+
+    dataset = h5xx::create_dataset<std::vector<int> >(
+        group, "scaleoffset", int_vector.size()
+      , h5xx::filter_pipeline().scaleoffset(H5Z_SO_INT, H5Z_SO_INT_MINBITS_DEFAULT)
+    );
+    BOOST_CHECK(filters(dataset) == std::vector<H5Z_filter_t>(1, H5Z_FILTER_SCALEOFFSET));
+    h5xx::write_dataset(dataset, int_vector);
+
+    dataset = h5xx::create_dataset<std::vector<int> >(
+        group, "nbit", int_vector.size(), h5xx::filter_pipeline().nbit().deflate(1)
+    );
+    h5xx::write_dataset(dataset, int_vector);
+
+    // chunked datasets
+    dataset = h5xx::create_chunked_dataset<array_type>(
+        group, "chunked", H5S_UNLIMITED, h5xx::chunk_policy(), h5xx::filter_pipeline().shuffle().deflate(1)
+    );
+    BOOST_CHECK(filters(dataset).size() == 2);
+    for (unsigned i = 0; i < array_vector.size(); ++i) {
+        h5xx::write_chunked_dataset(dataset, array_vector[i]);
+    }
+    dataset = h5xx::create_chunked_dataset<array_type>(
+        group, "chunked_none", H5S_UNLIMITED, h5xx::chunk_policy(), h5xx::filter_pipeline()
+    );
+    BOOST_CHECK(filters(dataset).empty());
+
+    BOOST_CHECK_THROW(h5xx::filter_pipeline().deflate(10), h5xx::error);
+    BOOST_CHECK(h5xx::filter_pipeline::is_available(H5Z_FILTER_DEFLATE));
+    BOOST_CHECK(!h5xx::filter_pipeline::is_available(H5Z_filter_t(32000)));
+
+    // re-open file
+    file.reset(new H5::H5File(filename, H5F_ACC_RDONLY));
+    group = h5xx::open_group(*file, "/");
+
+    char const* names[] = { "none", "shuffle" };
+    for (unsigned j = 0; j < 2; ++j) {
+        array_vector_type array_vector_;
+        h5xx::read_dataset(group.openDataSet(names[j]), array_vector_);
+        BOOST_CHECK(array_vector_ == array_vector);
+    }
+    std::vector<int> int_vector_;
+    h5xx::read_dataset(group.openDataSet("scaleoffset"), int_vector_);
+    BOOST_CHECK(int_vector_ == int_vector);
+    h5xx::read_dataset(group.openDataSet("nbit"), int_vector_);
+    BOOST_CHECK(int_vector_ == int_vector);
+
+    array_vector_type array_vector_;
+    h5xx::read_chunked_dataset(group.openDataSet("chunked"), array_vector_, 0, array_vector.size());
+    BOOST_CHECK(array_vector_ == array_vector);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+/** number of open data type ids */
+static ssize_t open_types()
+{
+    hsize_t count = 0;
+    H5Inmembers(H5I_DATATYPE, &count);
+    return count;
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_dataset_ctype )
+{
+    char const filename[] = "test_h5xx_dataset_ctype.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // the same type id is returned on every call
+    hid_t hid = h5xx::detail::ctype<double>::hid();
+    BOOST_CHECK(hid >= 0);
+    BOOST_CHECK(h5xx::detail::ctype<double>::hid() == hid);
+    BOOST_CHECK(H5Tequal(hid, H5T_NATIVE_DOUBLE) > 0);
+    BOOST_CHECK(h5xx::detail::ctype<float>::hid() != hid);
+
+    // reads, writes and type checks do not leak type ids
+    typedef boost::array<double, 3> array_type;
+    H5::DataSet dataset = h5xx::create_dataset<array_type>(group, "array");
+    H5::DataSet chunked = h5xx::create_chunked_dataset<double>(group, "chunked");
+    array_type value = {{ 1, 2, 3 }};
+    h5xx::write_dataset(dataset, value);
+    h5xx::write_chunked_dataset(chunked, 1.);
+    h5xx::write_attribute(group, "attr", 1.);
+
+    ssize_t count = open_types();
+    for (int i = 0; i < 100; ++i) {
+        h5xx::write_dataset(dataset, value);
+        h5xx::read_dataset(dataset, value);
+        h5xx::write_chunked_dataset(chunked, double(i));
+        double x;
+        h5xx::read_chunked_dataset(chunked, x, i);
+        h5xx::write_attribute(group, "attr", x);
+        x = h5xx::read_attribute<double>(group, "attr");
+        BOOST_CHECK(h5xx::has_type<double>(chunked));
+        BOOST_CHECK(!h5xx::has_type<float>(chunked));
+        h5xx::chunked_dataset<double> handle(chunked);
+        handle.read(x, 0);
+    }
+    BOOST_CHECK(open_types() == count);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_dataset_compound )
+{
+    char const filename[] = "test_h5xx_dataset_compound.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    std::vector<test::particle> particles(100);
+    for (unsigned i = 0; i < particles.size(); ++i) {
+        test::particle& p = particles[i];
+        std::fill(p.position, p.position + 3, 0.5 * i);
+        p.velocity.assign(-float(i));
+        p.species = i % 3;
+        p.padding = 'x';
+    }
+
+    // compound type with named members
+    BOOST_CHECK(h5xx::has_ctype<test::particle>::value);
+    BOOST_CHECK(!h5xx::has_ctype<std::string>::value);
+    hid_t hid = h5xx::detail::ctype<test::particle>::hid();
+    BOOST_CHECK(H5Tget_class(hid) == H5T_COMPOUND);
+    BOOST_CHECK(H5Tget_size(hid) == sizeof(test::particle));
+    BOOST_CHECK(H5Tget_nmembers(hid) == 3);
+    BOOST_CHECK(H5Tget_member_index(hid, "velocity") == 1);
+    BOOST_CHECK(H5Tget_member_class(hid, 0) == H5T_ARRAY);
+    BOOST_CHECK(h5xx::detail::ctype<test::particle>::hid() == hid);
+
+    // vector of structs and single struct
+    H5::DataSet dataset = h5xx::create_dataset<std::vector<test::particle> >(group, "particles", particles.size());
+    h5xx::write_dataset(dataset, particles);
+    BOOST_CHECK(h5xx::has_type<test::particle>(dataset));
+    BOOST_CHECK(h5xx::elements(dataset) == particles.size());
+    h5xx::write_dataset(group, "particle", particles[1]);
+
+    // re-open file
+    file.reset(new H5::H5File(filename, H5F_ACC_RDONLY));
+    group = h5xx::open_group(*file, "/");
+
+    std::vector<test::particle> particles_;
+    h5xx::read_dataset(group, "particles", particles_);
+    BOOST_CHECK(particles_.size() == particles.size());
+    for (unsigned i = 0; i < particles.size(); ++i) {
+        BOOST_CHECK(particles_[i].position[2] == 0.5 * i);
+        BOOST_CHECK(particles_[i].velocity[0] == -float(i));
+        BOOST_CHECK(particles_[i].species == int(i % 3));
+    }
+
+    test::particle p;
+    h5xx::read_dataset(group, "particle", p);
+    BOOST_CHECK(p.position[0] == 0.5 && p.velocity[2] == -1 && p.species == 1);
+
+    // members are accessible by name through the HDF5 library
+    hid_t species_type = H5Tcreate(H5T_COMPOUND, sizeof(int));
+    H5Tinsert(species_type, "species", 0, H5T_NATIVE_INT);
+    std::vector<int> species(particles.size());
+    H5Dread(group.openDataSet("particles").getId(), species_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, &*species.begin());
+    H5Tclose(species_type);
+    BOOST_CHECK(species[5] == 2);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_dataset_storage )
+{
+    char const filename[] = "test_h5xx_dataset_storage.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    //
+    // conversion kernels agree with the HDF5 library for normal numbers
+    // except for ties, which HDF5 rounds away from zero
+    //
+    std::vector<float> values;
+    for (int e = -14; e < 16; ++e) {
+        for (int m = 0; m < 64; ++m) {
+            float x = std::ldexp(1 + m / 64.f + 1.f / 8192, e);
+            values.push_back(x);
+            values.push_back(-x);
+            values.push_back(std::ldexp(1 + m / 64.f + 3.f / 4096, e));
+        }
+    }
+    values.push_back(0);
+    values.push_back(65504);
+    values.push_back(65519);
+
+    std::vector<h5xx::half> half_values(values.size());
+    h5xx::detail::convert(&*values.begin(), &*half_values.begin(), values.size());
+    std::vector<float> converted(values);
+    H5Tconvert(H5T_NATIVE_FLOAT, h5xx::detail::ctype<h5xx::half>::hid(), values.size(), &*converted.begin(), NULL, H5P_DEFAULT);
+    boost::uint16_t const* bits = reinterpret_cast<boost::uint16_t const*>(&*converted.begin());
+    for (unsigned i = 0; i < values.size(); ++i) {
+        BOOST_CHECK_MESSAGE(half_values[i].bits == bits[i], "half precision of " << values[i]);
+    }
+
+    // ties, subnormal numbers and overflow are rounded as by IEEE 754
+    float special[] = {
+        1 + 1.f / 2048, 1 + 3.f / 2048, -65040
+      , std::ldexp(1.f, -25), std::ldexp(1.5f, -25), std::ldexp(1.f, -24)
+      , std::ldexp(1.5f, -24), std::ldexp(2.5f, -24), std::ldexp(1023.5f, -24)
+      , 65520, 1e10f, -std::numeric_limits<float>::infinity()
+    };
+    boost::uint16_t special_bits[] = { 0x3c00, 0x3c02, 0xfbf0, 0, 1, 1, 2, 2, 0x400, 0x7c00, 0x7c00, 0xfc00 };
+    unsigned const nspecial = sizeof(special) / sizeof(special[0]);
+    std::vector<h5xx::half> special_half(nspecial);
+    h5xx::detail::convert(special, &*special_half.begin(), nspecial);
+    for (unsigned i = 0; i < nspecial; ++i) {
+        BOOST_CHECK_MESSAGE(special_half[i].bits == special_bits[i], "half precision of " << special[i]);
+    }
+    float nan_value = std::numeric_limits<float>::quiet_NaN();
+    h5xx::half nan;
+    h5xx::detail::convert(&nan_value, &nan, 1);
+    BOOST_CHECK((nan.bits & 0x7c00) == 0x7c00 && (nan.bits & 0x3ff) != 0);
+
+    std::vector<double> double_values(values.begin(), values.end());
+    double_values.push_back(1. / 3);
+    std::vector<float> float_values(double_values.size());
+    h5xx::detail::convert(&*double_values.begin(), &*float_values.begin(), double_values.size());
+    for (unsigned i = 0; i < double_values.size(); ++i) {
+        BOOST_CHECK(float_values[i] == static_cast<float>(double_values[i]));
+    }
+
+    //
+    // datasets stored with reduced precision
+    //
+    std::vector<double> data(1000);
+    for (unsigned i = 0; i < data.size(); ++i) {
+        data[i] = std::sqrt(double(i)) - 10;
+    }
+
+    H5::DataSet float_dataset = h5xx::create_dataset<std::vector<double>, float>(group, "float", data.size());
+    BOOST_CHECK(h5xx::has_type<float>(float_dataset));
+    BOOST_CHECK(H5::DSetCreatPropList(float_dataset.getCreatePlist()).getNfilters() == 1);
+    h5xx::write_dataset(float_dataset, data);
+
+    H5::DataSet half_dataset = h5xx::create_dataset<std::vector<double>, h5xx::half>(
+        group, "half", data.size(), h5xx::filter_pipeline()
+    );
+    BOOST_CHECK(H5Tget_size(half_dataset.getDataType().getId()) == 2);
+    h5xx::write_dataset(half_dataset, data);
+
+    typedef boost::multi_array<float, 2> multi_array2;
+    multi_array2 multi_array_value(boost::extents[10][3]);
+    for (unsigned i = 0; i < multi_array_value.num_elements(); ++i) {
+        multi_array_value.data()[i] = 0.25f * i;
+    }
+    H5::DataSet multi_array_dataset
+        = h5xx::create_dataset<multi_array2, h5xx::half>(group, "multi_array", multi_array_value.shape());
+    h5xx::write_dataset(multi_array_dataset, multi_array_value);
+
+    typedef boost::array<double, 3> array_type;
+    array_type array_value = {{ 1. / 3, 2, 3 }};
+    h5xx::write_dataset(h5xx::create_dataset<array_type, float>(group, "array"), array_value);
+    h5xx::write_dataset(h5xx::create_dataset<double, float>(group, "scalar"), 1. / 3);
+
+    // integer storage types are converted by the HDF5 library
+    std::vector<int> int_data(100, 7);
+    h5xx::write_dataset(h5xx::create_dataset<std::vector<int>, short>(group, "short", int_data.size()), int_data);
+
+    //
+    // all write paths convert by the same kernels, including ties
+    //
+    std::vector<double> ties;
+    for (int i = 0; i < 16; ++i) {
+        ties.push_back(2049 + 2 * i);
+        ties.push_back(-(1 + (2 * i + 1) / 2048.));
+        ties.push_back(std::ldexp(1.5, -24 - i % 2));
+    }
+    boost::multi_array<double, 1> strided(boost::extents[2 * ties.size()]);
+    for (unsigned i = 0; i < ties.size(); ++i) {
+        strided[2 * i] = ties[i];
+        strided[2 * i + 1] = std::numeric_limits<double>::quiet_NaN();
+    }
+    typedef boost::multi_array_types::index_range range;
+    h5xx::write_dataset(h5xx::create_dataset<std::vector<double>, h5xx::half>(group, "ties/free", ties.size()), ties);
+    h5xx::write_dataset(
+        h5xx::create_dataset<std::vector<double>, h5xx::half>(group, "ties/view", ties.size())
+      , strided[boost::indices[range(0, strided.size(), 2)]]
+    );
+    h5xx::fixed_dataset<std::vector<double> > fixed_handle(
+        h5xx::create_dataset<std::vector<double>, h5xx::half>(group, "ties/handle", ties.size())
+    );
+    fixed_handle.write(ties);
+    h5xx::write_chunked_dataset(h5xx::create_chunked_dataset<std::vector<double>, h5xx::half>(group, "ties/chunked_free", ties.size()), ties);
+    h5xx::chunked_dataset<std::vector<double> > chunked_handle(
+        h5xx::create_chunked_dataset<std::vector<double>, h5xx::half>(group, "ties/chunked_handle", ties.size())
+    );
+    chunked_handle.write(ties);
+
+    std::vector<h5xx::half> expected(ties.size()), bits_;
+    h5xx::detail::convert(&*ties.begin(), &*expected.begin(), ties.size());
+    BOOST_CHECK(expected[0].bits == 0x6800); // 2049 → 2048
+    char const* ties_names[] = { "ties/free", "ties/view", "ties/handle" };
+    for (unsigned i = 0; i < 3; ++i) {
+        h5xx::read_dataset(group, ties_names[i], bits_);
+        for (unsigned j = 0; j < ties.size(); ++j) {
+            BOOST_CHECK_MESSAGE(bits_[j].bits == expected[j].bits, ties_names[i] << ": half precision of " << ties[j]);
+        }
+    }
+    char const* chunked_names[] = { "ties/chunked_free", "ties/chunked_handle" };
+    for (unsigned i = 0; i < 2; ++i) {
+        h5xx::read_chunked_dataset(group.openDataSet(chunked_names[i]), bits_, 0);
+        for (unsigned j = 0; j < ties.size(); ++j) {
+            BOOST_CHECK_MESSAGE(bits_[j].bits == expected[j].bits, chunked_names[i] << ": half precision of " << ties[j]);
+        }
+    }
+
+    // re-open file
+    file.reset(new H5::H5File(filename, H5F_ACC_RDONLY));
+    group = h5xx::open_group(*file, "/");
+
+    std::vector<double> data_;
+    h5xx::read_dataset(group, "float", data_);
+    for (unsigned i = 0; i < data.size(); ++i) {
+        BOOST_CHECK(data_[i] == static_cast<float>(data[i]));
+    }
+    h5xx::read_dataset(group, "half", data_);
+    for (unsigned i = 0; i < data.size(); ++i) {
+        BOOST_CHECK_SMALL(data_[i] - data[i], std::abs(data[i]) / 1024);
+    }
+    multi_array2 multi_array_value_;
+    h5xx::read_dataset(group, "multi_array", multi_array_value_);
+    BOOST_CHECK(multi_array_value_ == multi_array_value);
+
+    array_type array_value_;
+    h5xx::read_dataset(group, "array", array_value_);
+    BOOST_CHECK(array_value_[0] == static_cast<float>(1. / 3));
+    BOOST_CHECK(array_value_[2] == 3);
+    double scalar;
+    h5xx::read_dataset(group, "scalar", scalar);
+    BOOST_CHECK(scalar == static_cast<float>(1. / 3));
+
+    std::vector<int> int_data_;
+    h5xx::read_dataset(group, "short", int_data_);
+    BOOST_CHECK(int_data_ == int_data);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_dataset_handle )
+{
+    char const filename[] = "test_h5xx_dataset_handle.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // scalar type
+    h5xx::fixed_dataset<int> int_dataset(h5xx::create_dataset<int>(group, "int"));
+    int_dataset.write(42);
+    int int_value;
+    int_dataset.read(int_value);
+    BOOST_CHECK(int_value == 42);
+
+    // vector type, result is resized
+    std::vector<double> vector_value(100);
+    for (unsigned i = 0; i < vector_value.size(); ++i) {
+        vector_value[i] = std::sqrt(double(i));
+    }
+    h5xx::fixed_dataset<std::vector<double> > vector_dataset(
+        h5xx::create_dataset<std::vector<double>, float>(group, "vector", vector_value.size())
+    );
+    BOOST_CHECK(vector_dataset.shape()[0] == 100);
+    for (int i = 0; i < 3; ++i) {
+        vector_dataset.write(vector_value);
+    }
+    std::vector<double> vector_value_;
+    vector_dataset.read(vector_value_);
+    BOOST_CHECK(vector_value_.size() == vector_value.size());
+    BOOST_CHECK(vector_value_[10] == static_cast<float>(vector_value[10]));
+    BOOST_CHECK_THROW(vector_dataset.write(std::vector<double>(99)), std::runtime_error);
+
+    // multi-array type
+    typedef boost::multi_array<int, 2> multi_array2;
+    multi_array2 multi_array_value(boost::extents[3][4]);
+    for (unsigned i = 0; i < multi_array_value.num_elements(); ++i) {
+        multi_array_value.data()[i] = i;
+    }
+    h5xx::fixed_dataset<multi_array2> multi_array_dataset(
+        h5xx::create_dataset<multi_array2>(group, "multi_array", multi_array_value.shape())
+    );
+    multi_array_dataset.write(multi_array_value);
+    multi_array2 multi_array_value_;
+    multi_array_dataset.read(multi_array_value_);
+    BOOST_CHECK(multi_array_value_ == multi_array_value);
+    BOOST_CHECK_THROW(multi_array_dataset.write(multi_array2(boost::extents[4][3])), std::runtime_error);
+
+    // incompatible rank or shape
+    typedef boost::array<double, 3> array_type;
+    BOOST_CHECK_THROW(h5xx::fixed_dataset<array_type>(multi_array_dataset.dataset()), std::runtime_error);
+    BOOST_CHECK_THROW(h5xx::fixed_dataset<array_type>(vector_dataset.dataset()), std::runtime_error);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_dataset_reuse )
+{
+    char const filename[] = "test_h5xx_dataset_reuse.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    std::vector<double> data(10000);
+    hsize_t size = 0;
+    for (int i = 0; i < 10; ++i) {
+        std::fill(data.begin(), data.end(), i);
+        H5::DataSet dataset = h5xx::create_dataset<std::vector<double> >(
+            group, "checkpoint/data", data.size(), h5xx::filter_pipeline().deflate(), h5xx::reuse_existing
+        );
+        h5xx::write_dataset(dataset, data);
+        file->flush(H5F_SCOPE_GLOBAL);
+        if (i == 1) {
+            size = file->getFileSize();
+        }
+    }
+    // the file does not grow
+    BOOST_CHECK(file->getFileSize() == size);
+    std::vector<double> data_;
+    h5xx::read_dataset(group, "checkpoint/data", data_);
+    BOOST_CHECK(data_ == data);
+
+    // replacing the dataset wastes space
+    for (int i = 0; i < 2; ++i) {
+        h5xx::write_dataset(h5xx::create_dataset<std::vector<double> >(group, "checkpoint/data", data.size()), data);
+    }
+    file->flush(H5F_SCOPE_GLOBAL);
+    BOOST_CHECK(file->getFileSize() > size);
+
+    // incompatible datasets are replaced
+    h5xx::create_dataset<std::vector<double> >(
+        group, "checkpoint/data", 10, h5xx::filter_pipeline().deflate(), h5xx::reuse_existing
+    );
+    h5xx::read_dataset(group, "checkpoint/data", data_);
+    BOOST_CHECK(data_.size() == 10);
+    h5xx::create_dataset<std::vector<int> >(
+        group, "checkpoint/data", 100, h5xx::filter_pipeline().deflate(), h5xx::reuse_existing
+    );
+    BOOST_CHECK(h5xx::has_type<int>(group.openDataSet("checkpoint/data")));
+    h5xx::create_dataset<std::vector<int> >(
+        group, "checkpoint/data", 100, h5xx::filter_pipeline().shuffle().deflate(), h5xx::reuse_existing
+    );
+    BOOST_CHECK(H5::DSetCreatPropList(group.openDataSet("checkpoint/data").getCreatePlist()).getNfilters() == 2);
+
+    // scalar datasets
+    h5xx::write_dataset(h5xx::create_dataset<double>(group, "scalar", h5xx::filter_pipeline(), h5xx::reuse_existing), 1.);
+    h5xx::write_dataset(h5xx::create_dataset<double>(group, "scalar", h5xx::filter_pipeline(), h5xx::reuse_existing), 2.);
+    double scalar;
+    h5xx::read_dataset(group, "scalar", scalar);
+    BOOST_CHECK(scalar == 2);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_dataset_property )
+{
+    char const filename[] = "test_h5xx_dataset_property.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // shared property lists
+    BOOST_CHECK(h5xx::detail::link_create_property() == h5xx::detail::link_create_property());
+    std::vector<hsize_t> chunk_dim(1, 100);
+    hid_t cparms = h5xx::detail::dataset_create_property(chunk_dim, h5xx::filter_pipeline().deflate())->hid();
+    BOOST_CHECK(h5xx::detail::dataset_create_property(chunk_dim, h5xx::filter_pipeline().deflate())->hid() == cparms);
+    BOOST_CHECK(h5xx::detail::dataset_create_property(chunk_dim, h5xx::filter_pipeline().deflate(1))->hid() != cparms);
+    BOOST_CHECK(h5xx::detail::dataset_create_property(chunk_dim, h5xx::filter_pipeline().shuffle())->hid() != cparms);
+    BOOST_CHECK(h5xx::detail::dataset_create_property(std::vector<hsize_t>(1, 10), h5xx::filter_pipeline().deflate())->hid() != cparms);
+    BOOST_CHECK(H5Pget_layout(h5xx::detail::dataset_create_property(std::vector<hsize_t>(), h5xx::filter_pipeline())->hid()) == H5D_CONTIGUOUS);
+
+    // a full cache evicts the least recently used entry, whose property
+    // list remains valid as long as a handle is held
+    boost::shared_ptr<h5xx::detail::property_handle const> hot
+        = h5xx::detail::dataset_create_property(std::vector<hsize_t>(1, 1000), h5xx::filter_pipeline());
+    boost::shared_ptr<h5xx::detail::property_handle const> cold
+        = h5xx::detail::dataset_create_property(std::vector<hsize_t>(1, 1001), h5xx::filter_pipeline());
+    for (hsize_t i = 0; i < 100; ++i) {
+        h5xx::detail::dataset_create_property(std::vector<hsize_t>(1, 2000 + i), h5xx::filter_pipeline());
+        BOOST_CHECK(h5xx::detail::dataset_create_property(std::vector<hsize_t>(1, 1000), h5xx::filter_pipeline()) == hot);
+    }
+    BOOST_CHECK(h5xx::detail::dataset_create_property(std::vector<hsize_t>(1, 1001), h5xx::filter_pipeline()) != cold);
+    hsize_t chunk;
+    BOOST_CHECK(H5Pget_chunk(cold->hid(), 1, &chunk) == 1 && chunk == 1001);
+
+    // repeated creation of datasets does not allocate property lists
+    std::vector<double> data(1000, 1.);
+    h5xx::write_dataset(h5xx::create_dataset<std::vector<double> >(group, "species/0/position", data.size()), data);
+    h5xx::create_chunked_dataset<double>(group, "species/0/time");
+    // property list ids are numbered consecutively
+    hid_t id = H5Pcreate(H5P_DATASET_XFER);
+    H5Pclose(id);
+    for (int i = 0; i < 10; ++i) {
+        std::string name = "species/" + std::string(1, '0' + i);
+        h5xx::write_dataset(h5xx::create_dataset<std::vector<double> >(group, name + "/position", data.size()), data);
+        h5xx::create_chunked_dataset<double>(group, name + "/time");
+        h5xx::open_group(group, name + "/box");
+    }
+    hid_t id_ = H5Pcreate(H5P_DATASET_XFER);
+    H5Pclose(id_);
+    // the library registers a copy of the creation property list for each
+    // dataset of chunked layout, no further property lists are created
+    BOOST_CHECK_EQUAL(id_ - id - 1, 2 * 10);
+    H5::DataSet dataset = group.openDataSet("species/9/position");
+    BOOST_CHECK(H5::DSetCreatPropList(dataset.getCreatePlist()).getNfilters() == 1);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_dataset_tiling )
+{
+    char const filename[] = "test_h5xx_dataset_tiling.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // large datasets are split into tiles of equal size
+    std::vector<double> data(1000000);
+    for (unsigned i = 0; i < data.size(); ++i) {
+        data[i] = i;
+    }
+    H5::DataSet dataset = h5xx::create_dataset<std::vector<double> >(group, "vector", data.size());
+    std::vector<hsize_t> chunk = h5xx::chunk_shape(dataset);
+    BOOST_CHECK(chunk.size() == 1 && chunk[0] == 125000);
+    h5xx::write_dataset(dataset, data);
+
+    typedef boost::array<double, 3> array_type;
+    std::vector<array_type> array_data(100000);
+    chunk = h5xx::chunk_shape(h5xx::create_dataset<std::vector<array_type> >(group, "array_vector", array_data.size()));
+    BOOST_CHECK(chunk.size() == 2 && chunk[0] == 33334 && chunk[1] == 3);
+
+    typedef boost::multi_array<float, 3> multi_array3;
+    multi_array3 multi_array_value(boost::extents[4][500][1000]);
+    chunk = h5xx::chunk_shape(h5xx::create_dataset<multi_array3>(group, "multi_array", multi_array_value.shape()));
+    BOOST_CHECK(chunk[0] == 1 && chunk[1] == 250 && chunk[2] == 1000);
+
+    // small datasets are stored as a single chunk
+    chunk = h5xx::chunk_shape(h5xx::create_dataset<std::vector<double> >(group, "small", 1000));
+    BOOST_CHECK(chunk[0] == 1000);
+
+    // uncompressed datasets are stored contiguously
+    dataset = h5xx::create_dataset<std::vector<double> >(group, "contiguous", data.size(), h5xx::filter_pipeline());
+    BOOST_CHECK(H5::DSetCreatPropList(dataset.getCreatePlist()).getLayout() == H5D_CONTIGUOUS);
+
+    std::vector<double> data_;
+    h5xx::read_dataset(group, "vector", data_);
+    BOOST_CHECK(data_ == data);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_dataset_hyperslab )
+{
+    char const filename[] = "test_h5xx_dataset_hyperslab.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    // write disjoint parts of a vector from separate buffers
+    H5::DataSet dataset = h5xx::create_dataset<std::vector<int> >(group, "vector", 1000);
+    for (int part = 0; part < 4; ++part) {
+        std::vector<int> data(250);
+        for (unsigned i = 0; i < data.size(); ++i) {
+            data[i] = 250 * part + i;
+        }
+        h5xx::write_dataset(dataset, data, 250 * part);
+    }
+    h5xx::write_dataset(dataset, std::vector<int>(), 1000);
+    std::vector<int> data;
+    h5xx::read_dataset(dataset, data);
+    BOOST_CHECK(data.size() == 1000);
+    for (unsigned i = 0; i < data.size(); ++i) {
+        BOOST_CHECK(data[i] == int(i));
+    }
+    h5xx::read_dataset(dataset, data, 100, 10);
+    BOOST_CHECK(data.size() == 10 && data.front() == 100 && data.back() == 109);
+    BOOST_CHECK_THROW(h5xx::write_dataset(dataset, data, 995), std::runtime_error);
+    BOOST_CHECK_THROW(h5xx::read_dataset(dataset, data, 1001, 0), std::runtime_error);
+
+    // write tiles of a multi_array
+    typedef boost::multi_array<double, 2> multi_array2;
+    multi_array2::size_type shape[2] = { 20, 30 };
+    dataset = h5xx::create_dataset<multi_array2>(group, "multi_array", shape);
+    multi_array2 tile(boost::extents[10][15]);
+    for (unsigned i = 0; i < 2; ++i) {
+        for (unsigned j = 0; j < 2; ++j) {
+            for (unsigned k = 0; k < tile.num_elements(); ++k) {
+                tile.data()[k] = 10 * i + j;
+            }
+            multi_array2::size_type offset[2] = { 10 * i, 15 * j };
+            h5xx::write_dataset(dataset, tile, offset);
+        }
+    }
+    multi_array2 multi_array_value;
+    h5xx::read_dataset(dataset, multi_array_value);
+    BOOST_CHECK(multi_array_value[0][0] == 0);
+    BOOST_CHECK(multi_array_value[9][15] == 1);
+    BOOST_CHECK(multi_array_value[10][14] == 10);
+    BOOST_CHECK(multi_array_value[19][29] == 11);
+    multi_array2::size_type offset[2] = { 5, 10 }, count[2] = { 10, 10 };
+    h5xx::read_dataset(dataset, multi_array_value, offset, count);
+    BOOST_CHECK(multi_array_value.shape()[0] == 10 && multi_array_value.shape()[1] == 10);
+    BOOST_CHECK(multi_array_value[0][0] == 0);
+    BOOST_CHECK(multi_array_value[0][9] == 1);
+    BOOST_CHECK(multi_array_value[9][0] == 10);
+    BOOST_CHECK(multi_array_value[9][9] == 11);
+    offset[1] = 25;
+    BOOST_CHECK_THROW(h5xx::read_dataset(dataset, multi_array_value, offset, count), std::runtime_error);
+
+    // vector of arrays, stored in reduced precision
+    typedef boost::array<double, 3> array_type;
+    typedef std::vector<array_type> array_vector_type;
+    dataset = h5xx::create_dataset<array_vector_type, float>(group, "array_vector", 100);
+    array_vector_type array_data(50);
+    for (unsigned i = 0; i < array_data.size(); ++i) {
+        array_type r = {{ 1. / 3, double(i), -1 }};
+        array_data[i] = r;
+    }
+    h5xx::write_dataset(dataset, array_data, 50);
+    h5xx::read_dataset(dataset, array_data, 60, 5);
+    BOOST_CHECK(array_data.size() == 5);
+    BOOST_CHECK(array_data[0][0] == static_cast<float>(1. / 3));
+    BOOST_CHECK(array_data[4][1] == 14);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_dataset_multi_array_view )
+{
+    char const filename[] = "test_h5xx_dataset_multi_array_view.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    typedef boost::multi_array<double, 3> multi_array3;
+    typedef boost::multi_array<double, 2> multi_array2;
+    typedef multi_array3::index_range range;
+    multi_array3 array(boost::extents[4][5][6]);
+    for (unsigned i = 0; i < array.num_elements(); ++i) {
+        array.data()[i] = i;
+    }
+    multi_array2 value;
+
+    // regular strides
+    multi_array3::const_array_view<2>::type slice = array[boost::indices[range()][2][range(0, 6, 2)]];
+    multi_array2::size_type shape[2] = { 4, 3 };
+    h5xx::write_dataset(h5xx::create_dataset<multi_array2>(group, "slice", shape), slice);
+    h5xx::read_dataset(group, "slice", value);
+    BOOST_CHECK(value == slice);
+
+    // reversed and transposed views
+    multi_array3::const_array_view<2>::type reversed = array[boost::indices[range(3, -1, -1)][1][range()]];
+    multi_array2::size_type shape_reversed[2] = { 4, 6 };
+    h5xx::write_dataset(h5xx::create_dataset<multi_array2>(group, "reversed", shape_reversed), reversed);
+    h5xx::read_dataset(group, "reversed", value);
+    BOOST_CHECK(value == reversed);
+    BOOST_CHECK(value[0][0] == array[3][1][0]);
+
+    std::vector<double> raw(12);
+    for (unsigned i = 0; i < raw.size(); ++i) {
+        raw[i] = i;
+    }
+    boost::const_multi_array_ref<double, 2> transposed(&*raw.begin(), boost::extents[3][4], boost::fortran_storage_order());
+    multi_array2::size_type shape_transposed[2] = { 3, 4 };
+    h5xx::write_dataset(h5xx::create_dataset<multi_array2>(group, "transposed", shape_transposed), transposed);
+    h5xx::read_dataset(group, "transposed", value);
+    BOOST_CHECK(value == multi_array2(transposed));
+    BOOST_CHECK(value[1][0] == 1 && value[0][1] == 3);
+
+    // contiguous reference with float storage
+    boost::const_multi_array_ref<double, 2> ref(&*raw.begin(), boost::extents[3][4]);
+    h5xx::write_dataset(h5xx::create_dataset<multi_array2, float>(group, "ref", shape_transposed), ref);
+    h5xx::read_dataset(group, "ref", value);
+    BOOST_CHECK(value == multi_array2(ref));
+
+    // strided view stored as float, converted by the HDF5 library
+    h5xx::write_dataset(h5xx::create_dataset<multi_array2, float>(group, "slice_float", shape), slice);
+    h5xx::read_dataset(group, "slice_float", value);
+    BOOST_CHECK(value == slice);
+
+    // read into strided view
+    multi_array3 result(boost::extents[4][5][6]);
+    std::fill(result.data(), result.data() + result.num_elements(), -1);
+    h5xx::read_dataset(group.openDataSet("slice"), result[boost::indices[range()][2][range(0, 6, 2)]]);
+    BOOST_CHECK(result[3][2][4] == array[3][2][4]);
+    BOOST_CHECK(result[3][2][3] == -1);
+    BOOST_CHECK(result[0][1][0] == -1);
+    BOOST_CHECK_THROW(
+        h5xx::read_dataset(group.openDataSet("slice"), result[boost::indices[range()][2][range()]])
+      , std::runtime_error
+    );
+
+    // large transposed views are copied in several blocks
+    std::vector<double> large(600 * 500);
+    for (unsigned i = 0; i < large.size(); ++i) {
+        large[i] = i;
+    }
+    boost::const_multi_array_ref<double, 2> large_transposed(&*large.begin(), boost::extents[600][500], boost::fortran_storage_order());
+    multi_array2::size_type shape_large[2] = { 600, 500 };
+    H5::DataSet large_dataset = h5xx::create_dataset<multi_array2>(group, "large", shape_large);
+    h5xx::write_dataset(large_dataset, large_transposed);
+    h5xx::read_dataset(group, "large", value);
+    BOOST_CHECK(value == multi_array2(large_transposed));
+
+    std::vector<double> large_(large.size());
+    boost::multi_array_ref<double, 2> large_transposed_(&*large_.begin(), boost::extents[600][500], boost::fortran_storage_order());
+    h5xx::read_dataset(large_dataset, large_transposed_);
+    BOOST_CHECK(large_ == large);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
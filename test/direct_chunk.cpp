@@ -0,0 +1,305 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE h5xx_direct_chunk
+#include <boost/test/unit_test.hpp>
+
+#include <h5xx/h5xx.hpp>
+#include <h5xx/direct_chunk.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <cmath>
+#include <unistd.h>
+
+#include <test/ctest_full_output.hpp>
+
+BOOST_GLOBAL_FIXTURE( ctest_full_output );
+
+BOOST_AUTO_TEST_CASE( h5xx_direct_chunk_writer )
+{
+    // store H5File object in shared_ptr to destroy it before re-opening the file
+    char const filename[] = "test_h5xx_direct_chunk_writer.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    //
+    // append records with parallel compression
+    //
+
+    // scalar type spanning several chunks, incomplete last chunk is written upon flush()
+    H5::DataSet int_dataset = h5xx::create_chunked_dataset<int>(group, "int");
+    {
+        h5xx::direct_chunk_writer<int> writer(int_dataset, 3);
+        BOOST_CHECK(writer.threads() == 3);
+        for (int i = 0; i < 5000; ++i) {
+            writer.push_back(i);
+        }
+        BOOST_CHECK(writer.length() == 5000);
+        writer.flush();
+        BOOST_CHECK(h5xx::elements(int_dataset) == 5000);
+
+        // continue after flush, the last chunk is rewritten
+        for (int i = 5000; i < 5100; ++i) {
+            writer.push_back(i);
+        }
+    }
+    BOOST_CHECK(h5xx::elements(int_dataset) == 5100);
+
+    // continue existing dataset with incomplete last chunk
+    {
+        h5xx::direct_chunk_writer<int> writer(int_dataset, 1);
+        BOOST_CHECK(writer.length() == 5100);
+        writer.push_back(5100);
+    }
+    BOOST_CHECK(h5xx::elements(int_dataset) == 5101);
+
+    // multi-array type
+    typedef boost::multi_array<double, 2> multi_array2;
+    multi_array2 multi_array_value(boost::extents[3][4]);
+    H5::DataSet multi_array_dataset
+        = h5xx::create_chunked_dataset<multi_array2>(group, "multi_array", multi_array_value.shape());
+    {
+        h5xx::direct_chunk_writer<multi_array2> writer(multi_array_dataset);
+        for (int i = 0; i < 1000; ++i) {
+            std::fill(multi_array_value.data(), multi_array_value.data() + multi_array_value.num_elements(), std::sqrt(double(i)));
+            writer.push_back(multi_array_value);
+        }
+        // record of wrong shape
+        multi_array2 wrong_shape(boost::extents[4][3]);
+        BOOST_CHECK_THROW(writer.push_back(wrong_shape), std::runtime_error);
+    }
+
+    // byte shuffling before compression
+    H5::DataSet shuffle_dataset = h5xx::create_chunked_dataset<double>(
+        group, "shuffle", H5S_UNLIMITED, h5xx::chunk_policy::records(100), h5xx::filter_pipeline().shuffle().deflate(1)
+    );
+    {
+        h5xx::direct_chunk_writer<double> writer(shuffle_dataset, 2);
+        for (int i = 0; i < 250; ++i) {
+            writer.push_back(std::sqrt(double(i)));
+        }
+    }
+
+    // uncompressed dataset with small chunks
+    hsize_t dim[1] = { 0 };
+    hsize_t max_dim[1] = { H5S_UNLIMITED };
+    hsize_t chunk_dim[1] = { 4 };
+    H5::DSetCreatPropList cparms;
+    cparms.setChunk(1, chunk_dim);
+    group.createDataSet("raw", H5::PredType::NATIVE_UINT64, H5::DataSpace(1, dim, max_dim), cparms);
+    {
+        h5xx::direct_chunk_writer<uint64_t> writer(group.openDataSet("raw"), 2);
+        for (uint64_t i = 0; i < 10; ++i) {
+            writer.push_back(i * i);
+        }
+    }
+
+    // unsupported filter pipeline
+    H5::DataSet fletcher32_dataset = h5xx::create_chunked_dataset<int>(
+        group, "fletcher32", H5S_UNLIMITED, h5xx::chunk_policy(), h5xx::filter_pipeline().deflate().fletcher32()
+    );
+    BOOST_CHECK_THROW(h5xx::direct_chunk_writer<int>(fletcher32_dataset, 1), h5xx::error);
+
+    // fixed-size dataset cannot be extended
+    H5::DataSet fixed_dataset = h5xx::create_chunked_dataset<int>(group, "fixed", 2);
+    {
+        h5xx::direct_chunk_writer<int> writer(fixed_dataset, 1);
+        BOOST_CHECK(writer.length() == 2);
+        BOOST_CHECK_THROW(writer.push_back(3), std::runtime_error);
+    }
+
+    // unsupported datasets: wrong type, wrong rank, chunks not spanning records
+    BOOST_CHECK_THROW(h5xx::direct_chunk_writer<double>(int_dataset, 1), std::runtime_error);
+    BOOST_CHECK_THROW(h5xx::direct_chunk_writer<std::vector<int> >(int_dataset, 1), std::runtime_error);
+    hsize_t dim2[2] = { 0, 8 };
+    hsize_t max_dim2[2] = { H5S_UNLIMITED, 8 };
+    hsize_t chunk_dim2[2] = { 4, 4 };
+    cparms.setChunk(2, chunk_dim2);
+    group.createDataSet("split", H5::PredType::NATIVE_INT, H5::DataSpace(2, dim2, max_dim2), cparms);
+    BOOST_CHECK_THROW(h5xx::direct_chunk_writer<std::vector<int> >(group.openDataSet("split"), 1), h5xx::error);
+
+    // re-open file
+    file.reset(new H5::H5File(filename, H5F_ACC_RDONLY));
+    group = h5xx::open_group(*file, "/");
+
+    //
+    // read datasets through the filter pipeline of the HDF5 library
+    //
+
+    std::vector<int> int_vector;
+    h5xx::read_chunked_dataset(group.openDataSet("int"), int_vector, 0, 5101);
+    for (int i = 0; i < 5101; ++i) {
+        BOOST_CHECK(int_vector[i] == i);
+    }
+
+    boost::multi_array<double, 3> multi_array3;
+    h5xx::read_chunked_dataset(group.openDataSet("multi_array"), multi_array3, 0, 1000);
+    for (int i = 0; i < 1000; ++i) {
+        BOOST_CHECK(multi_array3[i][2][3] == std::sqrt(double(i)));
+    }
+
+    std::vector<double> double_vector;
+    h5xx::read_chunked_dataset(group.openDataSet("shuffle"), double_vector, 0, 250);
+    for (int i = 0; i < 250; ++i) {
+        BOOST_CHECK(double_vector[i] == std::sqrt(double(i)));
+    }
+
+    std::vector<uint64_t> uint_vector;
+    h5xx::read_chunked_dataset(group.openDataSet("raw"), uint_vector, 0, 10);
+    for (uint64_t i = 0; i < 10; ++i) {
+        BOOST_CHECK(uint_vector[i] == i * i);
+    }
+
+    BOOST_CHECK(h5xx::elements(group.openDataSet("fixed")) == 2);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_direct_chunk_reader )
+{
+    char const filename[] = "test_h5xx_direct_chunk_reader.hdf5";
+    boost::shared_ptr<H5::H5File> file(new H5::H5File(filename, H5F_ACC_TRUNC));
+    H5::Group group = h5xx::open_group(*file, "/");
+
+    //
+    // write datasets through the filter pipeline of the HDF5 library
+    //
+
+    H5::DataSet int_dataset = h5xx::create_chunked_dataset<int>(group, "int");
+    for (int i = 0; i < 5000; ++i) {
+        h5xx::write_chunked_dataset(int_dataset, i);
+    }
+
+    typedef boost::array<double, 3> array_type;
+    H5::DataSet array_dataset = h5xx::create_chunked_dataset<array_type>(group, "array");
+    for (int i = 0; i < 1000; ++i) {
+        array_type value = {{ double(i), std::sqrt(double(i)), -double(i) }};
+        h5xx::write_chunked_dataset(array_dataset, value);
+    }
+
+    typedef boost::multi_array<float, 2> multi_array2;
+    multi_array2 multi_array_value(boost::extents[3][4]);
+    H5::DataSet multi_array_dataset
+        = h5xx::create_chunked_dataset<multi_array2>(group, "multi_array", multi_array_value.shape());
+    for (int i = 0; i < 500; ++i) {
+        std::fill(multi_array_value.data(), multi_array_value.data() + multi_array_value.num_elements(), i);
+        h5xx::write_chunked_dataset(multi_array_dataset, multi_array_value);
+    }
+
+    H5::DataSet shuffle_dataset = h5xx::create_chunked_dataset<double>(
+        group, "shuffle", H5S_UNLIMITED, h5xx::chunk_policy::records(100), h5xx::filter_pipeline().shuffle().deflate(1)
+    );
+    for (int i = 0; i < 250; ++i) {
+        h5xx::write_chunked_dataset(shuffle_dataset, std::sqrt(double(i)));
+    }
+
+    // fixed-size dataset, only the first chunk is allocated
+    H5::DataSet fixed_dataset = h5xx::create_chunked_dataset<int>(group, "fixed", 5000);
+    h5xx::write_chunked_dataset(fixed_dataset, 1, 0);
+
+    // uncompressed dataset with small chunks
+    hsize_t dim[1] = { 0 };
+    hsize_t max_dim[1] = { H5S_UNLIMITED };
+    hsize_t chunk_dim[1] = { 4 };
+    H5::DSetCreatPropList cparms;
+    cparms.setChunk(1, chunk_dim);
+    H5::DataSet raw_dataset
+        = group.createDataSet("raw", H5::PredType::NATIVE_UINT64, H5::DataSpace(1, dim, max_dim), cparms);
+    for (uint64_t i = 0; i < 10; ++i) {
+        h5xx::write_chunked_dataset(raw_dataset, i * i);
+    }
+
+    // re-open file
+    file.reset(new H5::H5File(filename, H5F_ACC_RDONLY));
+    group = h5xx::open_group(*file, "/");
+
+    //
+    // read datasets with parallel decompression
+    //
+
+    h5xx::direct_chunk_reader reader(3);
+    BOOST_CHECK(reader.threads() == 3);
+
+    std::vector<int> int_vector;
+    reader.read(group.openDataSet("int"), int_vector, 0, 5000);
+    BOOST_CHECK(int_vector.size() == 5000);
+    for (int i = 0; i < 5000; ++i) {
+        BOOST_CHECK(int_vector[i] == i);
+    }
+    // strided read across chunk boundaries
+    reader.read(group.openDataSet("int"), int_vector, 7, 400, 11);
+    BOOST_CHECK(int_vector.size() == 400);
+    for (int i = 0; i < 400; ++i) {
+        BOOST_CHECK(int_vector[i] == 7 + 11 * i);
+    }
+    std::vector<int> int_vector_;
+    h5xx::read_chunked_dataset(group.openDataSet("int"), int_vector_, 7, 400, 11);
+    BOOST_CHECK(int_vector == int_vector_);
+
+    std::vector<array_type> array_vector;
+    reader.read(group.openDataSet("array"), array_vector, 500, 500);
+    for (int i = 0; i < 500; ++i) {
+        BOOST_CHECK(array_vector[i][1] == std::sqrt(double(500 + i)));
+    }
+
+    boost::multi_array<float, 3> multi_array3;
+    reader.read(group.openDataSet("multi_array"), multi_array3, 0, 250, 2);
+    BOOST_CHECK(multi_array3.shape()[0] == 250);
+    for (int i = 0; i < 250; ++i) {
+        BOOST_CHECK(multi_array3[i][2][3] == 2 * i);
+    }
+
+    std::vector<double> double_vector;
+    reader.read(group.openDataSet("shuffle"), double_vector, 0, 250);
+    for (int i = 0; i < 250; ++i) {
+        BOOST_CHECK(double_vector[i] == std::sqrt(double(i)));
+    }
+
+    // unallocated chunks are read through the library
+    reader.read(group.openDataSet("fixed"), int_vector, 0, 5000);
+    BOOST_CHECK(int_vector[0] == 1);
+    BOOST_CHECK(std::count(int_vector.begin(), int_vector.end(), 0) == 4999);
+
+    std::vector<uint64_t> uint_vector;
+    reader.read(group.openDataSet("raw"), uint_vector, 2, 8);
+    for (uint64_t i = 0; i < 8; ++i) {
+        BOOST_CHECK(uint_vector[i] == (i + 2) * (i + 2));
+    }
+
+    // flat array, empty range, invalid ranges and types
+    int int_array[3];
+    reader.read(group.openDataSet("int"), int_array, 4998, 2);
+    BOOST_CHECK(int_array[0] == 4998 && int_array[1] == 4999);
+    reader.read(group.openDataSet("int"), int_vector, 5000, 0);
+    BOOST_CHECK(int_vector.empty());
+    BOOST_CHECK_THROW(reader.read(group.openDataSet("int"), int_array, 4998, 3), std::runtime_error);
+    BOOST_CHECK_THROW(reader.read(group.openDataSet("int"), int_array, 0, 1, 0), std::runtime_error);
+    BOOST_CHECK_THROW(reader.read(group.openDataSet("int"), uint_vector, 0, 1), std::runtime_error);
+    BOOST_CHECK_THROW(reader.read(group.openDataSet("array"), int_vector, 0, 1), std::runtime_error);
+
+    // remove file
+#ifdef NDEBUG
+    file.reset();
+    unlink(filename);
+#endif
+}
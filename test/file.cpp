@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2014  Felix Höfling
+ *
+ * This file is part of h5xx.
+ *
+ * h5xx is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE h5xx_file
+#include <boost/test/unit_test.hpp>
+
+#include <h5xx/h5xx.hpp>
+
+#include <unistd.h>
+
+#include <test/ctest_full_output.hpp>
+
+BOOST_GLOBAL_FIXTURE( ctest_full_output );
+
+BOOST_AUTO_TEST_CASE( h5xx_file )
+{
+    char const filename[] = "test_h5xx_file.hdf5";
+
+    // presets
+    h5xx::file_access presets[] = {
+        h5xx::file_access()
+      , h5xx::file_access::streaming_append()
+      , h5xx::file_access::random_read()
+      , h5xx::file_access::checkpoint()
+      , h5xx::file_access::small_metadata()
+    };
+    std::vector<int> data(100000);
+    for (unsigned i = 0; i < data.size(); ++i) {
+        data[i] = i;
+    }
+    for (unsigned i = 0; i < sizeof(presets) / sizeof(presets[0]); ++i) {
+        // the file is closed only after all of its objects
+        std::string name = "test_h5xx_file_" + std::string(1, '0' + i) + ".hdf5";
+        {
+            H5::H5File file = h5xx::create_file(name, presets[i]);
+            h5xx::write_dataset(h5xx::create_dataset<std::vector<int> >(file, "group/data", data.size()), data);
+            h5xx::write_attribute(h5xx::open_group(file, "group"), "preset", i);
+        }
+        H5::H5File file = h5xx::open_file(name, H5F_ACC_RDONLY, presets[i]);
+        std::vector<int> data_;
+        h5xx::read_dataset(file, "group/data", data_);
+        BOOST_CHECK(data_ == data);
+        BOOST_CHECK(h5xx::read_attribute<unsigned>(h5xx::open_group(file, "group"), "preset") == i);
+#ifdef NDEBUG
+        unlink(name.c_str());
+#endif
+    }
+    BOOST_CHECK_THROW(h5xx::open_file("nonexistent.hdf5"), H5::FileIException);
+
+    // file access properties
+    H5::H5File file = h5xx::create_file(filename, h5xx::file_access::checkpoint().chunk_cache(1 << 20, 101, 0.5));
+    BOOST_CHECK_THROW(h5xx::create_file(filename, h5xx::file_access(), H5F_ACC_EXCL), H5::FileIException);
+    H5::FileAccPropList access = file.getAccessPlist();
+    hid_t fapl = access.getId();
+    H5F_libver_t low, high;
+    BOOST_CHECK(H5Pget_libver_bounds(fapl, &low, &high) >= 0);
+    BOOST_CHECK(low == h5xx::detail::libver_v18());
+    hsize_t threshold, alignment;
+    BOOST_CHECK(H5Pget_alignment(fapl, &threshold, &alignment) >= 0);
+    BOOST_CHECK(threshold == 1 << 20);
+    BOOST_CHECK(alignment == h5xx::detail::block_size(filename));
+    size_t sieve;
+    BOOST_CHECK(H5Pget_sieve_buf_size(fapl, &sieve) >= 0);
+    BOOST_CHECK(sieve == 4 << 20);
+    size_t nslots, nbytes;
+    double w0;
+    BOOST_CHECK(H5Pget_cache(fapl, NULL, &nslots, &nbytes, &w0) >= 0);
+    BOOST_CHECK(nslots == 101 && nbytes == 1 << 20 && w0 == 0.5);
+
+    // large datasets are aligned
+    H5::DataSet dataset = h5xx::create_dataset<std::vector<int> >(file, "data", 1 << 20, h5xx::filter_pipeline());
+    h5xx::write_dataset(dataset, std::vector<int>(1 << 20, 1));
+    BOOST_CHECK(H5Dget_offset(dataset.getId()) % alignment == 0);
+    file.close();
+
+    H5AC_cache_config_t config;
+    config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+    access = h5xx::file_access::random_read().property(filename);
+    BOOST_CHECK(H5Pget_mdc_config(access.getId(), &config) >= 0);
+    BOOST_CHECK(config.initial_size == 16 << 20 && config.max_size == 64 << 20);
+
+    BOOST_CHECK_THROW(h5xx::file_access().metadata_cache(2 << 20, 1 << 20), h5xx::error);
+    BOOST_CHECK_THROW(h5xx::file_access().chunk_cache(1 << 20, 101, 2), h5xx::error);
+
+    // remove file
+#ifdef NDEBUG
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_file_paged )
+{
+    char const filename[] = "test_h5xx_file_paged.hdf5";
+
+    // many small objects
+    {
+        H5::H5File file = h5xx::create_file(filename, h5xx::file_creation::paged(8192), h5xx::file_access::small_metadata());
+        H5::FileCreatPropList creation = file.getCreatePlist();
+        H5F_fspace_strategy_t strategy;
+        hbool_t persist;
+        hsize_t threshold, page_size;
+        BOOST_CHECK(H5Pget_file_space_strategy(creation.getId(), &strategy, &persist, &threshold) >= 0);
+        BOOST_CHECK(strategy == H5F_FSPACE_STRATEGY_PAGE);
+        BOOST_CHECK(H5Pget_file_space_page_size(creation.getId(), &page_size) >= 0);
+        BOOST_CHECK(page_size == 8192);
+        H5::FileAccPropList access = file.getAccessPlist();
+        size_t buf_size;
+        unsigned int min_meta, min_raw;
+        BOOST_CHECK(H5Pget_page_buffer_size(access.getId(), &buf_size, &min_meta, &min_raw) >= 0);
+        BOOST_CHECK(buf_size == 4 << 20);
+
+        for (int i = 0; i < 100; ++i) {
+            H5::Group group = h5xx::open_group(file, "step/" + std::string(1, '0' + i / 10) + std::string(1, '0' + i % 10));
+            h5xx::write_attribute(group, "step", i);
+            h5xx::write_dataset(h5xx::create_dataset<std::vector<int> >(group, "data", 4, h5xx::filter_pipeline()), std::vector<int>(4, i));
+        }
+    }
+
+    // read through page buffer
+    {
+        H5::H5File file = h5xx::open_file(filename, H5F_ACC_RDONLY, h5xx::file_access::random_read());
+        std::vector<int> data;
+        h5xx::read_dataset(file, "step/42/data", data);
+        BOOST_CHECK(data == std::vector<int>(4, 42));
+        BOOST_CHECK(h5xx::read_attribute<int>(h5xx::open_group(file, "step/99"), "step") == 99);
+    }
+
+    // page size defaults to block size of file system
+    char const filename_default[] = "test_h5xx_file_paged_default.hdf5";
+    H5::H5File file = h5xx::create_file(filename_default, h5xx::file_creation::paged(), h5xx::file_access().page_buffer(1 << 20));
+    H5::FileCreatPropList creation = file.getCreatePlist();
+    hsize_t page_size;
+    BOOST_CHECK(H5Pget_file_space_page_size(creation.getId(), &page_size) >= 0);
+    BOOST_CHECK(page_size == std::max(h5xx::detail::block_size(filename_default), hsize_t(512)));
+    BOOST_CHECK_THROW(h5xx::file_access().page_buffer(1 << 20, 60, 50), h5xx::error);
+
+    // remove file
+#ifdef NDEBUG
+    file.close();
+    unlink(filename);
+    unlink(filename_default);
+#endif
+}
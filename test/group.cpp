@@ -27,7 +27,7 @@
 
 #include <test/ctest_full_output.hpp>
 
-BOOST_GLOBAL_FIXTURE( ctest_full_output )
+BOOST_GLOBAL_FIXTURE( ctest_full_output );
 
 BOOST_AUTO_TEST_CASE( h5xx_group )
 {
@@ -114,3 +114,121 @@ BOOST_AUTO_TEST_CASE( h5xx_split_path )
     BOOST_CHECK(path.size() == 3);
     BOOST_CHECK(std::equal(path.begin(), path.end(), names.begin()));
 }
+
+BOOST_AUTO_TEST_CASE( h5xx_group_cache )
+{
+    char const filename[] = "test_h5xx_group_cache.hdf5";
+    H5::H5File file(filename, H5F_ACC_TRUNC);
+
+    BOOST_CHECK(h5xx::group_cache::normalize("") == "/");
+    BOOST_CHECK(h5xx::group_cache::normalize("//") == "/");
+    BOOST_CHECK(h5xx::group_cache::normalize("one//two/./three/") == "/one/two/three");
+
+    h5xx::group_cache cache(file);
+    BOOST_CHECK(h5xx::path(cache.open("/")) == "/");
+    BOOST_CHECK(cache.size() == 0);
+
+    // open creates the group and its parents
+    H5::Group group = cache.open("/particles/all/position");
+    BOOST_CHECK(h5xx::path(group) == "/particles/all/position");
+    BOOST_CHECK(cache.size() == 3);
+    BOOST_CHECK(h5xx::exists_group(file, "/particles/all"));
+
+    // cached handles are returned for equivalent paths
+    BOOST_CHECK(cache.open("particles//all/position/").getId() == group.getId());
+    BOOST_CHECK(cache.open("/particles").getId() == cache.open("particles").getId());
+    BOOST_CHECK(cache.size() == 3);
+
+    // datasets within cached groups
+    h5xx::write_dataset(
+        h5xx::create_dataset<std::vector<double> >(cache.open("/particles/all/position"), "value", 10)
+      , std::vector<double>(10, 1.)
+    );
+    h5xx::write_chunked_dataset(
+        h5xx::create_chunked_dataset<int>(cache.open("/observables"), "step"), 1
+    );
+    BOOST_CHECK(h5xx::exists_dataset(file, "/particles/all/position/value"));
+    BOOST_CHECK(h5xx::exists_dataset(file, "/observables/step"));
+
+    // unlinking evicts the group and its subgroups
+    cache.open("/particles/all/velocity");
+    cache.open("/particles/allx");
+    BOOST_CHECK(cache.size() == 6);
+    cache.unlink("/particles/all");
+    BOOST_CHECK(cache.size() == 3);
+    BOOST_CHECK(!h5xx::exists_group(file, "/particles/all"));
+    BOOST_CHECK(h5xx::exists_group(file, "/particles/allx"));
+    BOOST_CHECK_THROW(cache.unlink("/particles/all"), h5xx::error);
+
+    // recreated on demand
+    group = cache.open("/particles/all/position");
+    BOOST_CHECK(h5xx::exists_group(file, "/particles/all/position"));
+    BOOST_CHECK(!h5xx::exists_dataset(file, "/particles/all/position/value"));
+
+    // closing a returned handle does not affect the cache
+    group.close();
+    BOOST_CHECK(h5xx::path(cache.open("/particles/all/position")) == "/particles/all/position");
+
+    cache.invalidate("/");
+    BOOST_CHECK(cache.size() == 0);
+    cache.open("/a");
+    cache.clear();
+    BOOST_CHECK(cache.size() == 0);
+
+    file.close();
+
+    // remove file
+#ifdef NDEBUG
+    unlink(filename);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( h5xx_object_type )
+{
+    char const filename[] = "test_h5xx_object_type.hdf5";
+    H5::H5File file(filename, H5F_ACC_TRUNC);
+
+    H5::Group group = h5xx::open_group(file, "/one/two");
+    h5xx::create_chunked_dataset<double>(group, "dataset");
+    H5Lcreate_soft("/one/two/dataset", file.getId(), "/soft", H5P_DEFAULT, H5P_DEFAULT);
+    H5Lcreate_soft("/missing", file.getId(), "/dangling", H5P_DEFAULT, H5P_DEFAULT);
+
+    BOOST_CHECK(h5xx::object_type(file, "/") == H5O_TYPE_GROUP);
+    BOOST_CHECK(h5xx::object_type(file, "") == H5O_TYPE_UNKNOWN);
+    BOOST_CHECK(h5xx::object_type(file, "one") == H5O_TYPE_GROUP);
+    BOOST_CHECK(h5xx::object_type(file, "/one/two/dataset") == H5O_TYPE_DATASET);
+    BOOST_CHECK(h5xx::object_type(group, "dataset") == H5O_TYPE_DATASET);
+    BOOST_CHECK(h5xx::object_type(group, "/one") == H5O_TYPE_GROUP);
+    BOOST_CHECK(h5xx::object_type(file, "/soft") == H5O_TYPE_DATASET);
+    BOOST_CHECK(h5xx::object_type(file, "/dangling") == H5O_TYPE_UNKNOWN);
+    BOOST_CHECK(h5xx::object_type(file, "/one/three") == H5O_TYPE_UNKNOWN);
+    BOOST_CHECK(h5xx::object_type(file, "/one/two/dataset/x") == H5O_TYPE_UNKNOWN);
+
+    BOOST_CHECK(h5xx::exists_group(file, "/"));
+    BOOST_CHECK(h5xx::exists_group(file, "one//two/"));
+    BOOST_CHECK(!h5xx::exists_group(file, "/one/two/dataset"));
+    BOOST_CHECK(h5xx::exists_dataset(file, "/one/two/dataset"));
+    BOOST_CHECK(!h5xx::exists_dataset(file, "/one/two"));
+    BOOST_CHECK(!h5xx::exists_dataset(file, "/missing/dataset"));
+
+    std::vector<std::string> paths;
+    paths.push_back("/one/two/dataset");
+    paths.push_back("/one/two");
+    paths.push_back("/one/three/dataset");
+    paths.push_back("/one/three");
+    paths.push_back("one/two/dataset");
+    std::vector<H5O_type_t> types = h5xx::object_types(file, paths);
+    BOOST_CHECK(types.size() == paths.size());
+    BOOST_CHECK(types[0] == H5O_TYPE_DATASET);
+    BOOST_CHECK(types[1] == H5O_TYPE_GROUP);
+    BOOST_CHECK(types[2] == H5O_TYPE_UNKNOWN);
+    BOOST_CHECK(types[3] == H5O_TYPE_UNKNOWN);
+    BOOST_CHECK(types[4] == H5O_TYPE_DATASET);
+
+    file.close();
+
+    // remove file
+#ifdef NDEBUG
+    unlink(filename);
+#endif
+}